@@ -0,0 +1,146 @@
+/*******************************************************************************
+ Title          : bench_compact.cpp
+ Author         : Anna Cristina Karingal
+ Created on     : October 18, 2026
+ 
+ Description    : Measures how much faster a large tree is walked once its
+                    nodes have been compacted into one block, in depth first
+                    or van Emde Boas order.
+ 
+ Usage          : ./bench_compact [<leaves>] [<repeats>]
+ (leaves is the number of organisms in the tree, 1048576 by default; each walk
+ is timed repeats times, 5 by default, and the fastest time is printed.)
+ 
+ Build with     : g++ -std=c++11 -pthread -O2 -o bench_compact bench_compact.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp
+ 
+ Last modified  : October 18, 2026
+ 
+ *******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+/* Builds trees by joining two trees directly, which is how the list
+constructor combines them, without searching for the closest pair first. */
+class benchmark_tree : public binary_tree {
+
+public:
+    benchmark_tree() {}
+    benchmark_tree(const string &organism) : binary_tree(organism) {}
+    benchmark_tree(benchmark_tree &tree1, benchmark_tree &tree2) : binary_tree(tree1, tree2) {}
+};
+
+/* Builds a balanced tree over leaves with scores 1, 2, ..., n. Leaves and then
+each level of internal nodes are allocated in shuffled order, so that nodes
+next to each other in the tree are scattered across memory, as they are after
+a real build merges trees in order of closeness. */
+static benchmark_tree build_scattered(size_t n, mt19937 &random) {
+
+    vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    shuffle(order.begin(), order.end(), random);
+
+    vector<benchmark_tree> level(n);
+    for (size_t i = 0; i < n; i++) {
+        ostringstream organism;
+        organism << "org" << order[i] << " " << order[i] + 1;
+        level[order[i]] = benchmark_tree(organism.str());
+    }
+
+    while (level.size() > 1) {
+        size_t pairs = level.size() / 2;
+        vector<benchmark_tree> next((level.size() + 1) / 2);
+        order.resize(pairs);
+        for (size_t i = 0; i < pairs; i++) {
+            order[i] = i;
+        }
+        shuffle(order.begin(), order.end(), random);
+
+        for (size_t i = 0; i < pairs; i++) {
+            size_t p = order[i];
+            next[p] = benchmark_tree(level[2 * p], level[2 * p + 1]);
+        }
+        if (level.size() % 2 == 1) {
+            next.back() = level.back();
+        }
+        level.swap(next);
+    }
+    return level[0];
+}
+
+/* Returns the fastest of repeats walks over range, in milliseconds. Sums the
+scores so that the walk can't be optimized away. */
+static double time_walk(tree_range range, int repeats, double &checksum) {
+
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        double sum = 0;
+        for (tree_iterator it = range.begin(); it != range.end(); ++it) {
+            sum += it->get_score();
+        }
+        double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+        checksum += sum;
+    }
+    return best;
+}
+
+/******************************************************************************
+                                MAIN PROGRAM
+ ******************************************************************************/
+
+int main(int argc, const char * argv[]) {
+
+    long leaves = (argc >= 2) ? atol(argv[1]) : 1048576;
+    int repeats = (argc >= 3) ? atoi(argv[2]) : 5;
+    if (leaves < 1 || repeats < 1) {
+        cerr << "ERROR: Invalid arguments" << endl;
+        cerr << "Usage: ./bench_compact [<leaves>] [<repeats>]" << endl;
+        exit(-1);
+    }
+
+    mt19937 random(1);
+    benchmark_tree scattered = build_scattered(leaves, random);
+
+    const char *names[] = { "scattered", "dfs", "veb" };
+    double checksum = 0;
+    cout << leaves << " leaves, fastest of " << repeats << " walks, in ms" << endl;
+    cout << left << setw(12) << "layout" << right << setw(12) << "compact"
+         << setw(12) << "pre-order" << setw(12) << "in-order" << setw(12) << "leaves" << endl;
+
+    for (int layout = 0; layout < 3; layout++) {
+        binary_tree tree(scattered);
+        double compact_ms = 0;
+        if (layout > 0) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            tree.compact(layout == 1 ? DFS_LAYOUT : VEB_LAYOUT);
+            compact_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+
+        double pre = time_walk(tree.pre_order(), repeats, checksum);
+        double in = time_walk(tree.in_order(), repeats, checksum);
+        double leaf = time_walk(tree.leaves(), repeats, checksum);
+        cout << left << setw(12) << names[layout] << right << fixed << setprecision(1)
+             << setw(12) << compact_ms << setw(12) << pre << setw(12) << in << setw(12) << leaf << endl;
+    }
+
+    // Printed so the walks are kept
+    cerr << "checksum " << checksum << endl;
+    return 0;
+}
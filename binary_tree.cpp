@@ -4,10 +4,15 @@
  Created on:        December 6, 2014
  Description:       Binary Tree Class Implementation
  
- Last Modified:     December 14, 2014
+ Last Modified:     October 18, 2026
  
  *****************************************************************************/
 
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <functional>
+
 #include "binary_tree.h"
 
 /******************************************************************************
@@ -15,7 +20,7 @@
  ******************************************************************************/
  
 /* Constructs an empty tree */
-binary_tree::binary_tree() { root = NULL; }
+binary_tree::binary_tree() { root = NULL; names = NULL; }
 
 /* Constructs a single node tree from a single string organism containing the
 name and score of a single organism separated by whitespace. 
@@ -71,6 +76,7 @@ binary_tree::binary_tree(string organism) throw(invalid_argument, bad_alloc) {
     }
     
     root = r;
+    names = NULL;
 }
 
 /* Takes a non-empty list of single node binary trees. Finds the two trees, t1
@@ -82,17 +88,21 @@ copy of t1 and t2 as its left and right subtrees. The new tree is appended to
 the input list of binary trees. 
     Function keeps combining the two closest trees in the list until the list
 only contains one tree. This tree is a representation of the closeness and
-relationships between all the original single node trees. Space for a new copy 
-of this tree is allocated and the root of our tree is set to point to the root
-of this new tree.
+relationships between all the original single node trees. Our tree shares the
+nodes of this tree.
 */
-binary_tree::binary_tree (list<binary_tree> &trees) throw (invalid_argument, bad_alloc){
+binary_tree::binary_tree (list<binary_tree> &trees, build_engine engine) throw (invalid_argument, bad_alloc){
     
     if (trees.empty()){
         // Empty list, throw exception
         throw invalid_argument("Empty list");
     }
     
+    if (engine == SORTED_ENGINE) {
+        // Same merges, comparing only neighbours in score order
+        combine_sorted_neighbours(trees);
+    }
+    
     // Find closest trees and combine until one tree left in list
     while (trees.size() > 1){
         // Find trees in list with closest scores in root, remove from list.
@@ -101,16 +111,9 @@ binary_tree::binary_tree (list<binary_tree> &trees) throw (invalid_argument, bad
     }
     
     // One tree in list left, this is is the consolidated tree
-    // Allocate space and make a new copy of this tree
-    binary_tree *consolidated_tree = new binary_tree(trees.front());
-    
-    // If allocation failed, throw exception
-    if (consolidated_tree == NULL) {
-        throw bad_alloc();
-    }
-    
-    // Make this the root of your tree
-    root = consolidated_tree->get_root_ptr();
+    // Make its root the root of your tree
+    root = retain(trees.front().get_root_ptr());
+    names = NULL;
 
 }
 
@@ -119,36 +122,48 @@ binary_tree::binary_tree (list<binary_tree> &trees) throw (invalid_argument, bad
 root nodes of the two input trees as its root node. The root score is an
 average of the scores of the roots of the two trees and the root name is created
 by concatening the first three letters of t1 with the first three letters of t2.
-A copy of the input trees are attached to the new tree as its left & right
-subtrees */
+The root's height is the gap between the two trees' root scores, the same
+difference find_and_combine_closest_trees() compares, and its hash combines the
+hashes of the two trees so that every subtree's hash is known once it is built.
+The input trees are attached to the new tree as its left & right subtrees. Their
+nodes are shared rather than copied, since nodes never change once built. */
 binary_tree::binary_tree(binary_tree &tree1, binary_tree &tree2)  throw (bad_alloc){
     
-    // Create & allocate new root node with combined name and average score of two trees.
-    float avg_score = (tree1.get_root_score() + tree2.get_root_score())/2;
-    string combined_name = tree1.get_root_name().substr(0,3) + tree2.get_root_name().substr(0,3);
-    tree_node *new_root = new tree_node(combined_name, avg_score);
+    // Constructor sets newly created node as root and input trees as left and
+    // right subtrees.
+    root = join(tree1.get_root_ptr(), tree2.get_root_ptr());
+    names = NULL;
+    
+}
+
+/* Creates & allocates a new node with the combined name and average score of
+the roots of the two subtrees and takes a reference to each subtree. */
+tree_node *binary_tree::join(tree_node *left_ptr, tree_node *right_ptr) throw (bad_alloc){
     
-    // Make copies of input binary trees
-    binary_tree *left = new binary_tree(tree1);
-    binary_tree *right = new binary_tree(tree2);
+    float avg_score = (left_ptr->score + right_ptr->score)/2;
+    string combined_name = left_ptr->name.substr(0,3) + right_ptr->name.substr(0,3);
     
-    // Check to see if space for new node and/or new trees was allocated
-    if (new_root == NULL || left == NULL || right == NULL) {
+    // Node constructor computes the structural hash and score range of both
+    // subtrees
+    tree_node *new_node = new tree_node(combined_name, avg_score, left_ptr, right_ptr);
+    
+    // Check to see if space for new node was allocated
+    if (new_node == NULL) {
         throw bad_alloc();
     }
+    retain(left_ptr);
+    retain(right_ptr);
     
-    // Constructor sets newly created node as root and copies of input trees as
-    // left and right subtrees.
-    root = new_root;
-    root->left = left->get_root_ptr();
-    root->right = right->get_root_ptr();
+    // Record the score gap at which the two trees were merged
+    new_node->height = abs(left_ptr->score - right_ptr->score);
     
+    return new_node;
 }
 
-/* A copy constructor function that recursively traverses the tree rooted at
-tn_ptr in pre-order. Creates a new copy of each node to create a new tree
-identical to the one rooted at tn_ptr in data and structure, but rooted at
-new_ptr instead.
+/* Recursively traverses the tree rooted at tn_ptr in pre-order. Creates a new
+copy of each node to create a new tree identical to the one rooted at tn_ptr in
+data and structure, but rooted at new_ptr instead. The copy constructor used to
+do this; it now shares nodes, and nothing in binary_tree calls this.
 */
 void binary_tree::copy_tree(tree_node *tn_ptr, tree_node *&new_ptr) const  throw (bad_alloc){
 
@@ -162,6 +177,11 @@ void binary_tree::copy_tree(tree_node *tn_ptr, tree_node *&new_ptr) const  throw
         if (new_ptr == NULL) {
             throw bad_alloc();
         }
+        new_ptr->height = tn_ptr->height;
+        new_ptr->hash = tn_ptr->hash;
+        new_ptr->cluster_hash = tn_ptr->cluster_hash;
+        new_ptr->min_score = tn_ptr->min_score;
+        new_ptr->max_score = tn_ptr->max_score;
         
         // Recursively copy left and right subtrees
         copy_tree(tn_ptr->left, new_ptr->left);
@@ -174,33 +194,100 @@ void binary_tree::copy_tree(tree_node *tn_ptr, tree_node *&new_ptr) const  throw
     }
 }
 
-/* A public wrapper for the copy constructor function */
+/* The copy constructor shares the input tree's nodes instead of copying them.
+Nodes are never changed once built, and mutators copy the nodes they would
+change, so the two trees can't affect each other. The name index is shared the same
+way. */
 binary_tree::binary_tree(const binary_tree &tree){
-    copy_tree(tree.get_root_ptr(), root);
+    root = retain(tree.get_root_ptr());
+    names = retain_names(tree.names);
+}
+
+/* Shares the input tree's nodes, then lets go of this tree's old nodes. The
+input tree is retained first in case it is this tree. */
+binary_tree &binary_tree::operator = (const binary_tree &tree){
+    tree_node *new_root = retain(tree.get_root_ptr());
+    name_node *new_names = retain_names(tree.names);
+    release(root);
+    release_names(names);
+    root = new_root;
+    names = new_names;
+    return *this;
 }
 
 /******************************************************************************
     Destructors
  ******************************************************************************/
 
-/* A protected destructor function that traverses the tree in post-order and 
- destroys each node */
-void binary_tree::destroy(tree_node *&tn_ptr){
+/* Takes one more reference to a node, or to the block it was compacted into */
+tree_node *binary_tree::retain(tree_node *tn_ptr){
+    if (tn_ptr != NULL) {
+        atomic<int> &count = (tn_ptr->block != NULL) ? tn_ptr->block->ref_count : tn_ptr->ref_count;
+        count.fetch_add(1, memory_order_relaxed);
+    }
+    return tn_ptr;
+}
+
+/* A protected destructor function that drops a reference to the tree's root.
+If it was the last reference the node is deleted, which in turn drops a
+reference to each of its children. A node in a block instead drops a reference
+to its block; the last reference frees the whole block, whose nodes only point
+to each other. Uses an explicit stack rather than recursion so that very deep
+trees can't overflow the call stack. */
+void binary_tree::release(tree_node *&tn_ptr){
     
-    // If tree node is not emtpy
-   if (tn_ptr != NULL){
-        // Recursively destroy left and right subtrees
-        destroy (tn_ptr->left);
-        destroy (tn_ptr->right);
-       
-        // Delete root tree node
-        delete tn_ptr;
-        tn_ptr = NULL;
+    vector<tree_node *> stack;
+    if (tn_ptr != NULL) {
+        stack.push_back(tn_ptr);
+    }
+    tn_ptr = NULL;
+    
+    while (!stack.empty()) {
+        tree_node *current = stack.back();
+        stack.pop_back();
+        
+        if (current->block != NULL) {
+            release_block(current->block);
+            continue;
+        }
+        
+        // Node is still used by another tree or parent
+        if (current->ref_count.fetch_sub(1, memory_order_acq_rel) != 1) {
+            continue;
+        }
+        
+        if (current->left != NULL) {
+            stack.push_back(current->left);
+        }
+        if (current->right != NULL) {
+            stack.push_back(current->right);
+        }
+        
+        // Delete tree node
+        delete current;
     }
 }
 
+/* Drops a reference to a block. The last reference destroys every node in the
+block and frees the block's single allocation. */
+void binary_tree::release_block(node_block *block){
+    
+    if (block->ref_count.fetch_sub(1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    
+    for (size_t i = 0; i < block->count; i++) {
+        block->nodes[i].~tree_node();
+    }
+    operator delete(block->nodes);
+    delete block;
+}
+
 /* A public wrapper destructor function*/
-binary_tree::~binary_tree() { destroy(root); }
+binary_tree::~binary_tree() {
+    release(root);
+    release_names(names);
+}
 
 /******************************************************************************
     Variable/Characteristic Accessors
@@ -231,6 +318,579 @@ int binary_tree::height_of_node(tree_node *tn_ptr) const {
     }
 }
 
+/******************************************************************************
+    Mutators
+ ******************************************************************************/
+
+/* Parses the organism into a new leaf, then walks down from the root. At each
+internal node the walk stops if the new score is farther from the node's score
+range than the node's merge height: the organism would only have been merged
+with the node after the node itself was formed. Otherwise the walk moves to the
+child whose score range is closer. Because the score ranges of two siblings
+never overlap, and the organism only ever joins the side nearer to it, every
+subtree still covers a contiguous range of scores afterwards.
+    The subtree the walk stopped at is joined with the new leaf and the nodes
+above it are copied with copy_path(). Everything else is shared with the old
+version of the tree. The name index, rather than a search of every leaf, tells
+whether the name is already taken, and gets the new name only once the tree
+has been changed.
+*/
+void binary_tree::add_organism(string organism) throw (invalid_argument, bad_alloc){
+    
+    // Throws invalid_argument if organism is not valid
+    binary_tree leaf(organism);
+    string name = leaf.get_root_name();
+    float score = leaf.get_root_score();
+    
+    index_names();
+    float existing_score;
+    if (find_name(names, name, existing_score)) {
+        throw invalid_argument ("Multiple organisms with same name. '" + name + "' is already in the tree.");
+    }
+    name_node *new_names = insert_name(names, tree_node::name_hash(name), 0, name, score);
+    
+    // Empty tree: the new organism is the whole tree
+    if (root == NULL) {
+        root = retain(leaf.get_root_ptr());
+        release_names(names);
+        names = new_names;
+        return;
+    }
+    
+    vector<pair<tree_node *, bool> > path;
+    tree_node *current = root;
+    while (current->left != NULL && current->right != NULL
+           && distance_to_range(current, score) <= current->height) {
+        
+        bool go_left = distance_to_range(current->left, score) <= distance_to_range(current->right, score);
+        path.push_back(make_pair(current, go_left));
+        current = go_left ? current->left : current->right;
+    }
+    
+    try {
+        if (current->left == NULL && current->score == score) {
+            throw invalid_argument ("Multiple organisms with same score. Check input for duplicates.");
+        }
+        copy_path(path, join(current, leaf.get_root_ptr()));
+    }
+    catch (...) {
+        release_names(new_names);
+        throw;
+    }
+    
+    release_names(names);
+    names = new_names;
+}
+
+/* Looks up the organism's score in the name index and follows it down to the
+organism's leaf, then replaces its parent by its sibling, copying only the
+nodes above the parent. Removing the last organism empties the tree. */
+void binary_tree::remove_organism(const string &name) throw (invalid_argument, bad_alloc){
+    
+    index_names();
+    float score;
+    vector<pair<tree_node *, bool> > path;
+    if (!find_name(names, name, score) || !find_leaf(name, score, path)) {
+        string reason = "'" + name + "' is not an organism in the tree";
+        throw invalid_argument(reason);
+    }
+    name_node *new_names = erase_name(names, tree_node::name_hash(name), 0, name);
+    
+    // Only organism in tree
+    if (path.empty()) {
+        release(root);
+    }
+    else {
+        tree_node *parent = path.back().first;
+        tree_node *sibling = path.back().second ? parent->right : parent->left;
+        path.pop_back();
+        
+        try {
+            copy_path(path, retain(sibling));
+        }
+        catch (bad_alloc &ba) {
+            release_names(new_names);
+            throw;
+        }
+    }
+    
+    release_names(names);
+    names = new_names;
+}
+
+/* Walks back up the path from the bottom, creating a copy of each ancestor
+with the new subtree in place of the old one. join() recomputes each copy's
+name, score, height and hash from its children, and takes its own reference
+to them, so the reference to the subtree below is dropped once the copy above
+it has been made. The old root is released last; nodes it shared with the new
+root survive, the rest are deleted unless another tree still uses them. */
+void binary_tree::copy_path(vector<pair<tree_node *, bool> > &path, tree_node *replacement) throw (bad_alloc){
+    
+    tree_node *new_subtree = replacement;
+    
+    for (int i = (int) path.size() - 1; i >= 0; i--) {
+        tree_node *ancestor = path[i].first;
+        tree_node *copy;
+        
+        try {
+            if (path[i].second) {
+                copy = join(new_subtree, ancestor->right);
+            }
+            else {
+                copy = join(ancestor->left, new_subtree);
+            }
+        }
+        catch (bad_alloc &ba) {
+            release(new_subtree);
+            throw;
+        }
+        
+        release(new_subtree);
+        new_subtree = copy;
+    }
+    
+    release(root);
+    root = new_subtree;
+}
+
+/* Traverses the tree in pre-order with an explicit stack. Each stack entry
+keeps the node's depth and which side of its parent it is on. Every node
+visited between a parent and its right child is in the parent's left subtree
+and only changes the path below the parent, so when a node is reached the path
+can be cut back to its depth and the turn into it recorded. */
+bool binary_tree::find_leaf(const string &name, vector<pair<tree_node *, bool> > &path) const {
+    
+    path.clear();
+    if (root == NULL) {
+        return false;
+    }
+    
+    // Stack of (node, (depth, is left child))
+    vector<pair<tree_node *, pair<size_t, bool> > > stack;
+    stack.push_back(make_pair(root, make_pair((size_t) 0, false)));
+    
+    while (!stack.empty()) {
+        tree_node *current = stack.back().first;
+        size_t depth = stack.back().second.first;
+        bool is_left = stack.back().second.second;
+        stack.pop_back();
+        
+        path.resize(depth);
+        if (depth > 0) {
+            path[depth - 1].second = is_left;
+        }
+        
+        if (current->left == NULL && current->right == NULL) {
+            if (current->name == name) {
+                return true;
+            }
+        }
+        else {
+            // Path to the children runs through current
+            path.push_back(make_pair(current, false));
+            stack.push_back(make_pair(current->right, make_pair(depth + 1, false)));
+            stack.push_back(make_pair(current->left, make_pair(depth + 1, true)));
+        }
+    }
+    
+    path.clear();
+    return false;
+}
+
+/* Siblings cover score ranges that don't overlap, so at most one child's range
+holds the score and the walk never has to turn back. Trees joined by hand in
+any shape might break that; if the walk doesn't end at the organism's leaf the
+whole tree is searched instead. */
+bool binary_tree::find_leaf(const string &name, float score, vector<pair<tree_node *, bool> > &path) const {
+    
+    path.clear();
+    tree_node *current = root;
+    while (current != NULL && current->left != NULL && current->right != NULL) {
+        bool go_left = (score >= current->left->min_score && score <= current->left->max_score);
+        path.push_back(make_pair(current, go_left));
+        current = go_left ? current->left : current->right;
+    }
+    
+    if (current != NULL && current->name == name && current->score == score) {
+        return true;
+    }
+    return find_leaf(name, path);
+}
+
+/******************************************************************************
+    Name Index
+ ******************************************************************************/
+
+/* Adds every leaf to an empty index, one at a time. Nothing else holds the
+index yet, but insert_name() still copies the branch it changes, so each
+insertion releases the index it replaced. */
+void binary_tree::index_names() throw (bad_alloc){
+    
+    if (names != NULL) {
+        return;
+    }
+    
+    tree_range all_leaves = leaves();
+    for (tree_iterator it = all_leaves.begin(); it != all_leaves.end(); ++it) {
+        name_node *updated = insert_name(names, tree_node::name_hash(it->get_name()), 0,
+                                         it->get_name(), it->get_score());
+        release_names(names);
+        names = updated;
+    }
+}
+
+/* Takes one more reference to an index node */
+name_node *binary_tree::retain_names(name_node *nn){
+    if (nn != NULL) {
+        nn->ref_count.fetch_add(1, memory_order_relaxed);
+    }
+    return nn;
+}
+
+/* Drops a reference to an index node. The last reference deletes the node and
+drops a reference to each of its children, using an explicit stack as
+release() does. */
+void binary_tree::release_names(name_node *&nn){
+    
+    vector<name_node *> stack;
+    if (nn != NULL) {
+        stack.push_back(nn);
+    }
+    nn = NULL;
+    
+    while (!stack.empty()) {
+        name_node *current = stack.back();
+        stack.pop_back();
+        
+        if (current->ref_count.fetch_sub(1, memory_order_acq_rel) != 1) {
+            continue;
+        }
+        for (int i = 0; i < 16; i++) {
+            if (current->children[i] != NULL) {
+                stack.push_back(current->children[i]);
+            }
+        }
+        delete current;
+    }
+}
+
+/* Creates an index node with no entries or children and a reference count of 1 */
+static name_node *new_name_node(unsigned long long hash) throw (bad_alloc){
+    
+    name_node *nn = new name_node;
+    if (nn == NULL) {
+        throw bad_alloc();
+    }
+    nn->ref_count = 1;
+    nn->hash = hash;
+    for (int i = 0; i < 16; i++) {
+        nn->children[i] = NULL;
+    }
+    return nn;
+}
+
+/* Follows the name's hash 4 bits at a time until it reaches a group of
+entries, then looks for the name in that group. */
+bool binary_tree::find_name(const name_node *nn, const string &name, float &score){
+    
+    unsigned long long hash = tree_node::name_hash(name);
+    for (int shift = 0; nn != NULL && nn->entries.empty(); shift += 4) {
+        nn = nn->children[(hash >> shift) & 15];
+    }
+    
+    if (nn == NULL || nn->hash != hash) {
+        return false;
+    }
+    for (size_t i = 0; i < nn->entries.size(); i++) {
+        if (nn->entries[i].first == name) {
+            score = nn->entries[i].second;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* An empty slot becomes a new group holding just the name. A group with the
+same hash is copied with the name added. A group with another hash is pushed
+down into a new branch, and the name is then inserted into that branch; the two
+hashes differ somewhere, so the groups end up apart. A branch is copied,
+sharing every child but the one the name goes into. */
+name_node *binary_tree::insert_name(name_node *nn, unsigned long long hash, int shift,
+                                    const string &name, float score) throw (bad_alloc){
+    
+    if (nn == NULL || (!nn->entries.empty() && nn->hash == hash)) {
+        name_node *group = new_name_node(hash);
+        if (nn != NULL) {
+            group->entries = nn->entries;
+        }
+        group->entries.push_back(make_pair(name, score));
+        return group;
+    }
+    
+    if (!nn->entries.empty()) {
+        name_node *branch = new_name_node(0);
+        branch->children[(nn->hash >> shift) & 15] = retain_names(nn);
+        name_node *result;
+        try {
+            result = insert_name(branch, hash, shift, name, score);
+        }
+        catch (bad_alloc &ba) {
+            release_names(branch);
+            throw;
+        }
+        release_names(branch);
+        return result;
+    }
+    
+    int digit = (hash >> shift) & 15;
+    name_node *child = insert_name(nn->children[digit], hash, shift + 4, name, score);
+    name_node *copy;
+    try {
+        copy = new_name_node(0);
+    }
+    catch (bad_alloc &ba) {
+        release_names(child);
+        throw;
+    }
+    for (int i = 0; i < 16; i++) {
+        copy->children[i] = (i == digit) ? child : retain_names(nn->children[i]);
+    }
+    return copy;
+}
+
+/* A group is copied without the name, or dropped if the name was all it held.
+A branch is copied around its new child; if all it has left is one group,
+that group takes its place, so the index looks the same as if the name had
+never been added. */
+name_node *binary_tree::erase_name(name_node *nn, unsigned long long hash, int shift,
+                                   const string &name) throw (bad_alloc){
+    
+    if (!nn->entries.empty()) {
+        if (nn->entries.size() == 1) {
+            return NULL;
+        }
+        name_node *group = new_name_node(hash);
+        for (size_t i = 0; i < nn->entries.size(); i++) {
+            if (nn->entries[i].first != name) {
+                group->entries.push_back(nn->entries[i]);
+            }
+        }
+        return group;
+    }
+    
+    int digit = (hash >> shift) & 15;
+    name_node *child = erase_name(nn->children[digit], hash, shift + 4, name);
+    
+    // Children left, and the last one seen
+    int remaining = 0;
+    name_node *last = NULL;
+    for (int i = 0; i < 16; i++) {
+        name_node *c = (i == digit) ? child : nn->children[i];
+        if (c != NULL) {
+            remaining++;
+            last = c;
+        }
+    }
+    
+    if (remaining == 0) {
+        return NULL;
+    }
+    if (remaining == 1 && !last->entries.empty()) {
+        return (last == child) ? child : retain_names(last);
+    }
+    
+    name_node *copy;
+    try {
+        copy = new_name_node(0);
+    }
+    catch (bad_alloc &ba) {
+        release_names(child);
+        throw;
+    }
+    for (int i = 0; i < 16; i++) {
+        copy->children[i] = (i == digit) ? child : retain_names(nn->children[i]);
+    }
+    return copy;
+}
+
+/* Returns how far score is from the range [min_score, max_score] of the
+subtree rooted at tn_ptr, or 0 if it lies inside the range */
+float binary_tree::distance_to_range(tree_node *tn_ptr, float score) {
+    if (score < tn_ptr->min_score) {
+        return tn_ptr->min_score - score;
+    }
+    if (score > tn_ptr->max_score) {
+        return score - tn_ptr->max_score;
+    }
+    return 0;
+}
+
+/******************************************************************************
+    Node Layout
+ ******************************************************************************/
+
+/* Numbers the nodes in pre-order with an explicit stack, recording each node's
+children and the number of levels in its subtree, then chooses the order the
+nodes will be stored in. Every node is copied into its slot of one new block,
+with child pointers translated to slots of the same block. Finally this tree
+lets go of its old nodes and takes the block's root.
+    In DFS_LAYOUT order a node is followed by its whole left subtree and then
+its right subtree, so a subtree is one contiguous run of memory. VEB_LAYOUT
+order splits the tree at half its height: the top half is laid out first, then
+each subtree hanging below it, each part recursively split the same way. Any
+walk from the root to a leaf then touches O(log_B n) blocks of memory of any
+size B, without knowing B.
+*/
+void binary_tree::compact(node_layout layout) throw(bad_alloc){
+    
+    if (root == NULL) {
+        return;
+    }
+    
+    // Pre-order numbering
+    vector<tree_node *> nodes;
+    vector<size_t> left_child, right_child;
+    vector<pair<tree_node *, pair<size_t, bool> > > stack;
+    stack.push_back(make_pair(root, make_pair((size_t) 0, false)));
+    
+    while (!stack.empty()) {
+        tree_node *current = stack.back().first;
+        size_t parent = stack.back().second.first;
+        bool is_left = stack.back().second.second;
+        stack.pop_back();
+        
+        size_t idx = nodes.size();
+        nodes.push_back(current);
+        left_child.push_back(0);
+        right_child.push_back(0);
+        if (idx > 0) {
+            if (is_left) {
+                left_child[parent] = idx;
+            }
+            else {
+                right_child[parent] = idx;
+            }
+        }
+        
+        if (current->left != NULL && current->right != NULL) {
+            stack.push_back(make_pair(current->right, make_pair(idx, false)));
+            stack.push_back(make_pair(current->left, make_pair(idx, true)));
+        }
+    }
+    
+    // Slot each pre-order number is stored in
+    vector<size_t> slot(nodes.size());
+    if (layout == VEB_LAYOUT) {
+        veb_order(left_child, right_child, slot);
+    }
+    else {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            slot[i] = i;
+        }
+    }
+    
+    // One allocation for every node
+    node_block *block = new node_block;
+    if (block == NULL) {
+        throw bad_alloc();
+    }
+    block->count = 0;
+    block->ref_count = 1;
+    try {
+        block->nodes = static_cast<tree_node *>(operator new(nodes.size() * sizeof(tree_node)));
+    }
+    catch (bad_alloc &ba) {
+        delete block;
+        throw;
+    }
+    
+    for (size_t i = 0; i < nodes.size(); i++) {
+        tree_node *old_node = nodes[i];
+        tree_node *new_node = new (&block->nodes[slot[i]]) tree_node(old_node->name, old_node->score);
+        new_node->height = old_node->height;
+        new_node->hash = old_node->hash;
+        new_node->cluster_hash = old_node->cluster_hash;
+        new_node->min_score = old_node->min_score;
+        new_node->max_score = old_node->max_score;
+        new_node->block = block;
+        if (old_node->left != NULL) {
+            new_node->left = &block->nodes[slot[left_child[i]]];
+            new_node->right = &block->nodes[slot[right_child[i]]];
+        }
+    }
+    block->count = nodes.size();
+    
+    // Pre-order number 0 is the root
+    tree_node *new_root = &block->nodes[slot[0]];
+    release(root);
+    root = new_root;
+}
+
+/* Lays out nodes in van Emde Boas order without recursion. A task (node, h)
+stands for the top h levels of the subtree rooted at node. A task of one level
+is just its node. Any other task is split into its top half, whose nodes are
+above depth h/2, and one task for each node at depth h/2 covering the rest of
+the levels below it. The top half is pushed last so that it is laid out first,
+and the lower tasks are pushed in reverse so they come out left to right.
+Pre-order numbers of the nodes are used throughout, and a node's number of
+levels is known once its children's are, i.e. by a reverse pre-order pass.
+*/
+void binary_tree::veb_order(const vector<size_t> &left_child, const vector<size_t> &right_child, vector<size_t> &slot){
+    
+    size_t n = left_child.size();
+    
+    // Levels in each node's subtree (1 for a leaf)
+    vector<size_t> levels(n, 1);
+    for (size_t i = n; i-- > 0;) {
+        if (left_child[i] != 0) {
+            levels[i] = 1 + max(levels[left_child[i]], levels[right_child[i]]);
+        }
+    }
+    
+    size_t next_slot = 0;
+    vector<pair<size_t, size_t> > tasks;
+    tasks.push_back(make_pair((size_t) 0, levels[0]));
+    
+    vector<pair<size_t, size_t> > walk;
+    vector<size_t> frontier;
+    
+    while (!tasks.empty()) {
+        size_t node = tasks.back().first;
+        size_t h = min(tasks.back().second, levels[tasks.back().first]);
+        tasks.pop_back();
+        
+        if (h == 1) {
+            slot[node] = next_slot++;
+            continue;
+        }
+        
+        size_t top = h / 2;
+        
+        // Nodes at depth top below node, left to right
+        frontier.clear();
+        walk.clear();
+        walk.push_back(make_pair(node, (size_t) 0));
+        while (!walk.empty()) {
+            size_t current = walk.back().first;
+            size_t depth = walk.back().second;
+            walk.pop_back();
+            
+            if (depth == top) {
+                frontier.push_back(current);
+            }
+            else if (left_child[current] != 0) {
+                walk.push_back(make_pair(right_child[current], depth + 1));
+                walk.push_back(make_pair(left_child[current], depth + 1));
+            }
+        }
+        
+        for (size_t i = frontier.size(); i-- > 0;) {
+            tasks.push_back(make_pair(frontier[i], h - top));
+        }
+        tasks.push_back(make_pair(node, top));
+    }
+}
+
 /******************************************************************************
     Constructor Helper Functions
  ******************************************************************************/
@@ -335,6 +995,200 @@ void binary_tree::find_and_combine_closest_trees(list<binary_tree> &trees) throw
     
 }
 
+/* Gap between two neighbours in score order. Gaps are ordered the way the
+full search picks its pair: by size, then by where the two trees are in the
+list. The slot versions tell whether either tree has been combined since. */
+struct neighbour_gap {
+    float diff;
+    size_t first_stamp, second_stamp;
+    size_t low, high;
+    size_t low_version, high_version;
+    
+    bool operator > (const neighbour_gap &other) const {
+        if (diff != other.diff) {
+            return diff > other.diff;
+        }
+        if (first_stamp != other.first_stamp) {
+            return first_stamp > other.first_stamp;
+        }
+        return second_stamp > other.second_stamp;
+    }
+};
+
+/* Three facts make comparing neighbours enough:
+    - For scores a < b < c, the rounded difference c - a is at least twice the
+        smaller of b - a and c - b, since rounding never reverses an order and
+        doubling is exact. So the closest pair, and every pair tied with it, is
+        a pair of neighbours in score order.
+    - The rounded average of a and b lies between a and b, so a combined tree
+        takes the place of the two it replaces in score order.
+    - Erasing trees from a list keeps the order of the rest, and combined trees
+        go to the end, so a counter handed out in list order (a stamp) orders
+        the trees as the list does. Equal gaps go to the smaller pair of stamps,
+        as the full search, scanning pairs in list order, keeps the first one.
+Each tree has a slot. Slots are linked in score order, and a heap holds the gap
+between every pair of linked neighbours. A combined tree takes the lower slot
+of its pair and the higher one is unlinked; entries for either slot that are
+still in the heap are skipped once popped. Trees that share a name or a score,
+or a score that is not finite, are handed back to the full search, which
+throws the same exception it would have thrown had it built the tree itself.
+*/
+void binary_tree::combine_sorted_neighbours(list<binary_tree> &trees) throw(invalid_argument, bad_alloc) {
+    
+    if (trees.empty()){
+        // Empty list, throw exception
+        throw invalid_argument("Empty list");
+    }
+    
+    const size_t NONE = (size_t) -1;
+    
+    vector<binary_tree> slots(trees.begin(), trees.end());
+    size_t slot_count = slots.size();
+    vector<size_t> stamps(slot_count), versions(slot_count, 0);
+    vector<size_t> lower(slot_count, NONE), higher(slot_count, NONE);
+    unordered_map<string, size_t> name_counts;
+    bool clean = true;
+    
+    for (size_t i = 0; i < slot_count; i++) {
+        stamps[i] = i;
+        if (++name_counts[slots[i].get_root_name()] > 1 || !isfinite(slots[i].get_root_score())) {
+            clean = false;
+        }
+    }
+    
+    // Link slots in score order. Scores that are not finite cannot be sorted
+    // and are left to the full search.
+    vector<pair<float, size_t> > by_score(slot_count);
+    for (size_t i = 0; i < slot_count; i++) {
+        by_score[i] = make_pair(slots[i].get_root_score(), i);
+    }
+    if (clean) {
+        sort(by_score.begin(), by_score.end());
+        for (size_t k = 0; k + 1 < slot_count; k++) {
+            lower[by_score[k + 1].second] = by_score[k].second;
+            higher[by_score[k].second] = by_score[k + 1].second;
+        }
+    }
+    
+    priority_queue<neighbour_gap, vector<neighbour_gap>, greater<neighbour_gap> > gaps;
+    
+    // Slots whose gap to their higher neighbour needs queueing: at first all
+    // of them, then the combined tree and its lower neighbour
+    vector<size_t> to_queue;
+    for (size_t k = 0; k < slot_count; k++) {
+        to_queue.push_back(by_score[k].second);
+    }
+    
+    size_t remaining = slot_count;
+    size_t next_stamp = slot_count;
+    size_t last = by_score[0].second;
+    
+    while (clean && remaining > 1) {
+        
+        for (size_t k = 0; k < to_queue.size(); k++) {
+            size_t low = to_queue[k];
+            if (low == NONE || higher[low] == NONE) {
+                continue;
+            }
+            
+            neighbour_gap gap;
+            gap.low = low;
+            gap.high = higher[low];
+            gap.diff = abs(slots[gap.low].get_root_score() - slots[gap.high].get_root_score());
+            gap.first_stamp = min(stamps[gap.low], stamps[gap.high]);
+            gap.second_stamp = max(stamps[gap.low], stamps[gap.high]);
+            gap.low_version = versions[gap.low];
+            gap.high_version = versions[gap.high];
+            
+            // Two trees with the same score
+            if (gap.diff == 0) {
+                clean = false;
+            }
+            gaps.push(gap);
+        }
+        to_queue.clear();
+        
+        if (!clean) {
+            break;
+        }
+        
+        // Skip gaps to trees that have since been combined with another
+        neighbour_gap gap = gaps.top();
+        gaps.pop();
+        if (versions[gap.low] != gap.low_version || versions[gap.high] != gap.high_version) {
+            continue;
+        }
+        
+        // The tree that comes first in the list becomes the left subtree
+        size_t first = gap.low, second = gap.high;
+        if (stamps[first] > stamps[second]) {
+            swap(first, second);
+        }
+        binary_tree combined(slots[first], slots[second]);
+        name_counts[slots[first].get_root_name()]--;
+        name_counts[slots[second].get_root_name()]--;
+        
+        // Combined tree takes the lower slot; the higher one is unlinked
+        slots[gap.low] = combined;
+        slots[gap.high] = binary_tree();
+        stamps[gap.low] = next_stamp++;
+        versions[gap.low]++;
+        versions[gap.high]++;
+        higher[gap.low] = higher[gap.high];
+        if (higher[gap.high] != NONE) {
+            lower[higher[gap.high]] = gap.low;
+        }
+        last = gap.low;
+        remaining--;
+        
+        // A name or score the full search would stop at
+        if (++name_counts[combined.get_root_name()] > 1 || !isfinite(combined.get_root_score())) {
+            clean = false;
+        }
+        
+        to_queue.push_back(lower[gap.low]);
+        to_queue.push_back(gap.low);
+    }
+    
+    trees.clear();
+    
+    if (clean) {
+        trees.push_back(slots[last]);
+        return;
+    }
+    
+    // Hand the remaining trees, in list order, to the full search
+    vector<pair<size_t, size_t> > by_stamp;
+    for (size_t i = 0; i < slot_count; i++) {
+        if (slots[i].get_root_ptr() != NULL) {
+            by_stamp.push_back(make_pair(stamps[i], i));
+        }
+    }
+    sort(by_stamp.begin(), by_stamp.end());
+    for (size_t k = 0; k < by_stamp.size(); k++) {
+        trees.push_back(slots[by_stamp[k].second]);
+    }
+    
+    while (trees.size() > 1){
+        find_and_combine_closest_trees(trees);
+    }
+}
+
+/******************************************************************************
+    Traversals
+ ******************************************************************************/
+
+/* Returns a range over the tree's nodes starting at the root */
+tree_range binary_tree::traverse(traversal_order order) const { return tree_range(root, order); }
+
+tree_range binary_tree::pre_order() const { return traverse(PRE_ORDER); }
+
+tree_range binary_tree::in_order() const { return traverse(IN_ORDER); }
+
+tree_range binary_tree::post_order() const { return traverse(POST_ORDER); }
+
+tree_range binary_tree::leaves() const { return traverse(LEAF_ORDER); }
+
 /******************************************************************************
     Functions to print the tree to console
  ******************************************************************************/
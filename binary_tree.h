@@ -14,13 +14,26 @@
                         - a single tree that represents the heirarchy of a
                             given list of organisms represented by single node
                             binary trees
-                    - Binary Tree destructors
+                    - Two engines that build the tree from a list: the
+                        original search over every pair of trees, and one
+                        that only compares neighbours in score order and
+                        builds the same tree in O(n log n)
+                    - Binary Tree destructors. Trees share nodes by
+                        reference count, so copies take O(1) time and space
+                    - Mutators that add or remove a single organism, copying
+                        only the nodes on the path they change, and an index of
+                        organism names, shared between copies, that finds the
+                        path without searching the whole tree
+                    - Compaction of a finished tree into one block of memory
+                        in depth first or van Emde Boas order
                     - Member variable/tree characteristic accessors and
                         calculators to retrieve root pointer, root name, root
                         score and height of tree.
                     - Functions to print a binary tree to console
+                    - Non-recursive pre-order, in-order, post-order and leaf
+                        traversals
 
- Last Modified:     December 14, 2014 
+ Last Modified:     October 18, 2026 
  
  *****************************************************************************/
 
@@ -31,19 +44,38 @@
 #include <sstream>
 #include <string>
 #include <list>
+#include <vector>
+#include <utility>
 #include <cmath>
 #include <new>
 #include <stdexcept>
 
 #include "tree_node.h"
+#include "tree_iterator.h"
 
 using namespace std;
 
+/* Order binary_tree::compact() stores a tree's nodes in */
+enum node_layout {
+    DFS_LAYOUT,     // pre-order: each subtree is one contiguous run
+    VEB_LAYOUT      // van Emde Boas: recursively split at half height
+};
+
+/* Algorithm binary_tree(list<binary_tree> &trees, build_engine) builds with */
+enum build_engine {
+    REFERENCE_ENGINE,   // compare every pair of trees each round, O(n^3)
+    SORTED_ENGINE       // compare neighbours in score order only, O(n log n)
+};
+
 class binary_tree {
     
 private:
     tree_node *root;
     
+    // Index from organism name to score, or NULL until a mutator first needs
+    // it. Built once from the leaves, then kept up to date by each mutator.
+    name_node *names;
+    
 protected:
 
 /******************************************************************************
@@ -59,11 +91,14 @@ protected:
         @pre        tree1 and tree2 are both intialized non-empty binary_trees
                     whose roots each contain the valid string names n1 and n2
                     and valid float scores s1 and s2 of an organism.
-        @post       Tree created contains root whose score s = (s1+s2)/2 and 
-                    whose name is the first 3 letters of n1 concatenated by the 
-                    first 3 letters of n2. tree1 and tree2 are the left and
-                    right subtrees of the tree respectively and the data and
-                    structure they contain remain unchanged.
+        @post       Tree created contains root whose score s = (s1+s2)/2, 
+                    whose height is |s1-s2|, whose hash is the merge hash of
+                    the two trees' root hashes and whose name is the first 3
+                    letters of n1 concatenated by the first 3 letters of n2.
+                    tree1 and tree2 are the left and right subtrees of the tree
+                    respectively and the data and structure they contain remain
+                    unchanged. The subtrees are shared with tree1 and tree2,
+                    not copied.
    */
     binary_tree (binary_tree &tree1, binary_tree &tree2) throw(bad_alloc);
     
@@ -71,24 +106,205 @@ protected:
     Protected Helper Functions for Public Constructors and Destructors
  ******************************************************************************/
     
-    /* void destroy(tree_node *&tn_ptr);
-    Traverses tree rooted at tn_ptr and destroys each node, including tn_ptr.
-        @param      tree_node *&tn_ptr;     [in/out] root of tree to destroy
-        @pre        tn_ptr is the root of a non-empty tree
-        @post       tn_pointer is deallocated and NULL, as are any and all of 
-                    its descendents.
+    /* static tree_node *retain(tree_node *tn_ptr);
+    Adds a reference to the tree rooted at tn_ptr.
+        @param      tree_node *tn_ptr       [in] root of tree to share, or NULL
+        @return     tree_node *             [out] tn_ptr
+        @pre        tn_ptr is NULL or an initialized tree_node.
+        @post       tn_ptr's reference count is incremented.
+   */
+    static tree_node *retain(tree_node *tn_ptr);
+    
+    /* static void release(tree_node *&tn_ptr);
+    Drops a reference to the tree rooted at tn_ptr. Traverses the tree and
+    destroys each node, including tn_ptr, that is no longer used by any other
+    tree.
+        @param      tree_node *&tn_ptr;     [in/out] root of tree to release
+        @pre        tn_ptr is NULL or the root of a tree the caller holds a
+                    reference to.
+        @post       tn_ptr is NULL. Every node whose reference count dropped
+                    to 0 is deallocated. Nodes still shared are unchanged.
+   */
+    static void release(tree_node *&tn_ptr);
+    
+    /* static void release_block(node_block *block);
+    Drops a reference to a block of compacted nodes.
+        @param      node_block *block       [in] block to release
+        @pre        Caller holds a reference to block.
+        @post       If it was the last reference, every node in the block is
+                    destroyed and the block is deallocated.
+   */
+    static void release_block(node_block *block);
+    
+    /* static void veb_order(const vector<size_t> &left_child, const vector<size_t> &right_child, vector<size_t> &slot);
+    Computes the van Emde Boas layout of a tree whose nodes are numbered in
+    pre-order.
+        @param      const vector<size_t> &left_child    [in] pre-order number
+                                            of each node's left child, 0 for
+                                            leaves
+        @param      const vector<size_t> &right_child   [in] same for right
+        @param      vector<size_t> &slot    [out] position of each node in the
+                                            layout
+        @pre        Node 0 is the root. slot has one entry per node.
+        @post       slot is a permutation of 0 .. n-1 in van Emde Boas order.
+   */
+    static void veb_order(const vector<size_t> &left_child, const vector<size_t> &right_child, vector<size_t> &slot);
+    
+    /* static tree_node *join(tree_node *left_ptr, tree_node *right_ptr) throw(bad_alloc);
+    Creates a new node whose left and right subtrees are the trees rooted at
+    left_ptr and right_ptr, the same way the combining constructor does.
+        @param      tree_node *left_ptr     [in] root of left subtree
+        @param      tree_node *right_ptr    [in] root of right subtree
+        @return     tree_node *             [out] new node, reference count 1
+        @pre        left_ptr and right_ptr are non-empty, initialized nodes
+                    with scores s1 and s2 and names n1 and n2.
+        @post       New node has score (s1+s2)/2, height |s1-s2|, name first 3
+                    letters of n1 followed by first 3 letters of n2, and holds
+                    a reference to both subtrees.
+   */
+    static tree_node *join(tree_node *left_ptr, tree_node *right_ptr) throw(bad_alloc);
+    
+    /* void copy_path(vector<pair<tree_node *, bool> > &path, tree_node *replacement) throw(bad_alloc);
+    Replaces the last node of path by replacement, copying every node on the
+    path above it and recomputing their names, scores, heights and hashes.
+    Nodes off the path are shared, not copied.
+        @param      vector<pair<tree_node *, bool> > &path  [in] ancestors of
+                                            the replaced node from the root
+                                            down, each paired with whether the
+                                            path turns left below it
+        @param      tree_node *replacement  [in] new subtree, whose reference
+                                            the tree takes over. May be NULL
+                                            only if path is empty.
+        @pre        path leads from this tree's root to the parent of the node
+                    being replaced.
+        @post       root points to a new tree in which the replaced subtree is
+                    replacement. Trees sharing the old root are unchanged.
+   */
+    void copy_path(vector<pair<tree_node *, bool> > &path, tree_node *replacement) throw(bad_alloc);
+    
+    /* bool find_leaf(const string &name, vector<pair<tree_node *, bool> > &path) const;
+    Searches the tree for the leaf holding organism name.
+        @param      const string &name      [in] name of organism to find
+        @param      vector<pair<tree_node *, bool> > &path  [out] ancestors of
+                                            the leaf, from the root down, each
+                                            paired with whether the path turns
+                                            left below it
+        @return     bool                    [out] true if leaf was found
+        @pre        None.
+        @post       If found, path leads from the root to the leaf's parent.
+   */
+    bool find_leaf(const string &name, vector<pair<tree_node *, bool> > &path) const;
+    
+    /* bool find_leaf(const string &name, float score, vector<pair<tree_node *, bool> > &path) const;
+    Finds the leaf holding organism name, whose score is score, by walking
+    down from the root into the child whose score range holds score.
+        @param      const string &name      [in] name of organism to find
+        @param      float score             [in] score of organism
+        @param      vector<pair<tree_node *, bool> > &path  [out] as for
+                                            find_leaf(name, path)
+        @return     bool                    [out] true if leaf was found
+        @pre        None.
+        @post       If found, path leads from the root to the leaf's parent.
+                    Takes time proportional to the depth of the leaf when
+                    sibling score ranges don't overlap; else falls back to
+                    searching the whole tree.
+   */
+    bool find_leaf(const string &name, float score, vector<pair<tree_node *, bool> > &path) const;
+    
+    /* void index_names() throw(bad_alloc);
+    Builds the name index from the tree's leaves if it has not been built.
+        @pre        None.
+        @post       names holds the name and score of every leaf. Takes O(n)
+                    time the first time, O(1) after that.
+   */
+    void index_names() throw(bad_alloc);
+    
+    /* static name_node *retain_names(name_node *nn);
+    Adds a reference to the name index rooted at nn.
+        @param      name_node *nn           [in] root of index, or NULL
+        @return     name_node *             [out] nn
+        @pre        nn is NULL or an initialized name_node.
+        @post       nn's reference count is incremented.
+   */
+    static name_node *retain_names(name_node *nn);
+    
+    /* static void release_names(name_node *&nn);
+    Drops a reference to the name index rooted at nn, deleting every index
+    node no longer used by another index.
+        @param      name_node *&nn          [in/out] root of index to release
+        @pre        nn is NULL or the root of an index the caller holds a
+                    reference to.
+        @post       nn is NULL. Nodes still shared are unchanged.
+   */
+    static void release_names(name_node *&nn);
+    
+    /* static bool find_name(const name_node *nn, const string &name, float &score);
+    Looks up an organism's score in the name index rooted at nn.
+        @param      const name_node *nn     [in] root of index, or NULL
+        @param      const string &name      [in] name of organism
+        @param      float &score            [out] its score, if found
+        @return     bool                    [out] true if name is in the index
+        @pre        None.
+        @post       Index is unchanged. Runs in O(log n) expected time.
+   */
+    static bool find_name(const name_node *nn, const string &name, float &score);
+    
+    /* static name_node *insert_name(name_node *nn, unsigned long long hash, int shift, const string &name, float score) throw(bad_alloc);
+    Returns a copy of the index rooted at nn with name added, copying only the
+    nodes on name's branch.
+        @param      name_node *nn           [in] root of index, or NULL
+        @param      unsigned long long hash [in] name hash of name
+        @param      int shift               [in] bits of hash used above nn
+        @param      const string &name      [in] name of organism
+        @param      float score             [in] score of organism
+        @return     name_node *             [out] root of new index,
+                                            reference count 1
+        @pre        name is not in the index.
+        @post       Index rooted at nn is unchanged and shares its other
+                    nodes with the new one.
    */
-    void destroy(tree_node *&tn_ptr);
+    static name_node *insert_name(name_node *nn, unsigned long long hash, int shift, const string &name, float score) throw(bad_alloc);
+    
+    /* static name_node *erase_name(name_node *nn, unsigned long long hash, int shift, const string &name) throw(bad_alloc);
+    Returns a copy of the index rooted at nn without name, copying only the
+    nodes on name's branch. A branch left with a single group of entries is
+    replaced by that group.
+        @param      name_node *nn           [in] root of index
+        @param      unsigned long long hash [in] name hash of name
+        @param      int shift               [in] bits of hash used above nn
+        @param      const string &name      [in] name of organism
+        @return     name_node *             [out] root of new index, or NULL
+                                            if it is empty
+        @pre        name is in the index rooted at nn.
+        @post       Index rooted at nn is unchanged and shares its other
+                    nodes with the new one.
+   */
+    static name_node *erase_name(name_node *nn, unsigned long long hash, int shift, const string &name) throw(bad_alloc);
+    
+    /* static float distance_to_range(tree_node *tn_ptr, float score);
+    Returns how far score is from the range of scores in the tree rooted at
+    tn_ptr.
+        @param      tree_node *tn_ptr       [in] root of tree
+        @param      float score             [in] score to measure from
+        @return     float                   [out] distance to nearest end of
+                                            the range, 0 if score is inside it
+        @pre        tn_ptr is a non-empty, initialized node.
+        @post       Tree is unchanged.
+   */
+    static float distance_to_range(tree_node *tn_ptr, float score);
 
     /* void copy_tree(tree_node *tn_ptr, tree_node *&new_ptr) const throw(bad_alloc);
     Traverses tree t rooted at tn_ptr and makes a new copy at new_ptr that
-    contains the same data and structure as t.
+    contains the same data and structure as t. Copies of a tree share its
+    nodes, so nothing in binary_tree calls this any more; it is kept for
+    subclasses that need a tree no other tree shares.
         @param      tree_node *tn_ptr       [in]
         @param      tree_node *&new_ptr     [in/out] 
         @pre        tn_ptr is non-empty and initlalized and points to an 
                     initialized tree t.
         @post       new_ptr points to a new tree that contains the same data
-                    and structure of t, but in a different location in memory
+                    and structure of t, but in a different location in memory,
+                    shared with no other tree.
    */
     void copy_tree(tree_node *tn_ptr, tree_node *&new_ptr) const throw(bad_alloc);
 
@@ -113,6 +329,24 @@ protected:
                     concatenated by first 3 letters of n2.
    */
     void find_and_combine_closest_trees(list<binary_tree> &trees) throw(invalid_argument, bad_alloc);
+
+    /* void combine_sorted_neighbours(list<binary_tree> &trees) throw(invalid_argument, bad_alloc);
+    Combines all trees in the list into one, making exactly the merges that
+    calling find_and_combine_closest_trees() until one tree is left would
+    make, in O(n log n) time. The closest pair of trees is always a pair of
+    neighbours in score order, so only neighbours are compared; equal gaps go
+    to the pair that comes first in the list, as they do in the full search.
+    Falls back to find_and_combine_closest_trees() on the remaining trees as
+    soon as two of them share a name or a score, or a score is not finite, so
+    the same exception is thrown.
+        @param      list<binary_tree> &trees [in/out] list of binary trees to
+                                                combine
+        @pre        trees is a non-empty, initialized list of non-empty,
+                    initialized binary trees.
+        @post       trees holds a single tree, the same one the full search
+                    builds. Else throws invalid_argument.
+   */
+    void combine_sorted_neighbours(list<binary_tree> &trees) throw(invalid_argument, bad_alloc);
     
 /******************************************************************************
     Protected Accessors
@@ -206,13 +440,15 @@ public:
    */
     binary_tree (string organism) throw(invalid_argument, bad_alloc);
     
-    /* binary_tree (list<binary_tree> &trees) throw(invalid_argument, bad_alloc);
+    /* binary_tree (list<binary_tree> &trees, build_engine engine = REFERENCE_ENGINE) throw(invalid_argument, bad_alloc);
     Takes a list of single node binary trees that each represent a single
     organism, and creates a single binary tree that groups all organisms in the
     list together by the closeness of their genome scores.
         @param      list<binary> &trees     [in/out] list of single node binary
                                             trees, each containing the valid
                                             name and score of a valid organism   
+        @param      build_engine engine     [in] algorithm to build with. Both
+                                            build the same tree.
         @pre        trees is an initialized, non-empty, list of unique non-empty, 
                     initialized single node binary trees. Each binary tree in
                     the list contains the valid name and score of a single
@@ -228,25 +464,112 @@ public:
                     scores are the closest to each other of all nodes in 
                     master_tree.
    */
-    binary_tree (list<binary_tree> &trees) throw(invalid_argument, bad_alloc);
+    binary_tree (list<binary_tree> &trees, build_engine engine = REFERENCE_ENGINE) throw(invalid_argument, bad_alloc);
     
     /* binary_tree (const binary_tree &tree);
-    Creates new tree that contains the same data and strucure as input tree
+    Creates new tree that contains the same data and strucure as input tree.
+    Nodes are shared between the two trees, so the copy takes O(1) time and
+    space; later changes to either tree copy only the nodes they touch.
         @param      binary_tree &tree   [in] tree to make a copy of    
         @pre        tree is an intialized binary_tree
-        @post       Tree created contains same data and structure of input tree, 
-                    but at a different location in memory.
+        @post       Tree created contains same data and structure of input tree. 
    */
     binary_tree (const binary_tree &tree);
     
     /* ~binary_tree();
-    Destroys tree and deallocates any memory.
+    Destroys tree and deallocates any memory not shared with another tree.
         @pre        tree is an intialized, non-empty binary_tree
         @post       Tree data is purged, memory used to store tree is
                     deallocated to ensure no memory leaks or dangling pointers.
     */
     ~binary_tree ();
     
+    /* binary_tree &operator = (const binary_tree &tree);
+    Makes this tree contain the same data and structure as input tree, sharing
+    its nodes.
+        @param      const binary_tree &tree [in] tree to copy
+        @return     binary_tree &           [out] this tree
+        @pre        tree is an initialized binary_tree
+        @post       This tree has the same data and structure as tree. Nodes
+                    only this tree used before are deallocated.
+   */
+    binary_tree &operator = (const binary_tree &tree);
+
+/******************************************************************************
+    Public Mutators
+ ******************************************************************************/
+
+    /* void add_organism(string organism) throw(invalid_argument, bad_alloc);
+    Parses organism the same way the single organism constructor does and adds
+    it to the tree as a new leaf. Starting from the root, the new organism
+    moves towards the subtree whose range of scores is closest to its score.
+    It stops at the first subtree it is farther from than that subtree's merge
+    height, or at a leaf, and is joined to that subtree as its right sibling.
+    Only the nodes on the path from the root to the new leaf, and on one
+    branch of the name index, are copied. Apart from building the name index
+    on the first change, takes time proportional to the depth of the new leaf.
+        @param      string organism     [in] string containing name and genome
+                                        score of a single organism
+        @pre        organism is valid, and no organism in the tree has the same
+                    name.
+        @post       Tree contains the new organism. Every subtree still covers
+                    a contiguous range of scores. Copies of the tree made before
+                    the change are unchanged. Else throws exception.
+   */
+    void add_organism(string organism) throw(invalid_argument, bad_alloc);
+    
+    /* void remove_organism(const string &name) throw(invalid_argument, bad_alloc);
+    Removes organism name from the tree. Its sibling takes the place of their
+    parent, and only the nodes above the parent, and on one branch of the name
+    index, are copied. The leaf is found through the name index and its score,
+    so apart from building the index on the first change, this takes time
+    proportional to the depth of the leaf.
+        @param      const string &name  [in] name of organism to remove
+        @pre        An organism named name is a leaf of the tree.
+        @post       Tree no longer contains the organism; if it was the only
+                    organism, the tree is empty. Copies of the tree made before
+                    the change are unchanged. Else throws invalid_argument.
+   */
+    void remove_organism(const string &name) throw(invalid_argument, bad_alloc);
+    
+    /* void compact(node_layout layout = DFS_LAYOUT) throw(bad_alloc);
+    Moves every node of the tree into one contiguous block of memory, in the
+    order given by layout, so that later traversals and queries touch memory
+    in order instead of wherever the allocator placed each node while the tree
+    was built. Meant to be called once the tree is finished.
+        @param      node_layout layout  [in] DFS_LAYOUT or VEB_LAYOUT
+        @pre        None.
+        @post       Tree has the same data and structure, stored in a single
+                    block. Copies of the tree made before compacting keep the
+                    old nodes. Later changes copy nodes out of the block as
+                    usual; the block is freed once no tree uses any of it.
+   */
+    void compact(node_layout layout = DFS_LAYOUT) throw(bad_alloc);
+    
+
+/******************************************************************************
+    Public Traversals
+ ******************************************************************************/
+
+    /* tree_range traverse(traversal_order order) const;
+    Returns a traversal of every node of the tree in the given order, for use
+    with range-for or standard algorithms. Nodes are visited without recursion.
+        @param      traversal_order order   [in] PRE_ORDER, IN_ORDER,
+                                            POST_ORDER or LEAF_ORDER
+        @return     tree_range              [out] nodes of tree in order
+        @pre        None.
+        @post       Range is valid until the tree is changed or destroyed.
+                    An empty tree gives an empty range.
+   */
+    tree_range traverse(traversal_order order) const;
+    
+    /* Shorthands for traverse(PRE_ORDER), traverse(IN_ORDER),
+    traverse(POST_ORDER) and traverse(LEAF_ORDER) */
+    tree_range pre_order() const;
+    tree_range in_order() const;
+    tree_range post_order() const;
+    tree_range leaves() const;
+    
 
 /******************************************************************************
     Friend: Overloaded Operator to Print Tree to Console
@@ -270,6 +593,54 @@ public:
                     contained in their root. 
      */
     friend ostream &operator << (ostream &os, const binary_tree &tree);
+
+/******************************************************************************
+    Friend: Organism Pipeline
+ ******************************************************************************/
+
+    /* friend class organism_pipeline;
+    Allows the organism pipeline's build stage to reach the root of the tree it
+    builds so that it can serialize the tree one chunk at a time.
+     */
+    friend class organism_pipeline;
+
+/******************************************************************************
+    Friend: Dendrogram Index
+ ******************************************************************************/
+
+    /* friend class dendrogram_index;
+    Allows the dendrogram index to walk the tree from its root once to
+    precompute the clusters at every merge height.
+     */
+    friend class dendrogram_index;
+
+/******************************************************************************
+    Friend: Tree Diff
+ ******************************************************************************/
+
+    /* friend class tree_diff;
+    Allows a tree diff to walk two trees from their roots in step.
+     */
+    friend class tree_diff;
+
+/******************************************************************************
+    Friend: Tree Server
+ ******************************************************************************/
+
+    /* friend class tree_server;
+    Allows the tree server to find the path from the root to an organism when
+    asked how closely two organisms are related.
+     */
+    friend class tree_server;
+
+/******************************************************************************
+    Friend: Tree Serializer
+ ******************************************************************************/
+
+    /* friend class tree_serializer;
+    Allows the tree serializer to lay out the tree's nodes from its root.
+     */
+    friend class tree_serializer;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,277 @@
+/*****************************************************************************
+ Title:             bounded_queue.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Bounded Queue Class Template (Header Only)
+                    - Fixed capacity ring buffer connecting exactly one
+                        producer thread to exactly one consumer thread,
+                        lock-free while neither has to wait
+                    - Non-blocking push/pop and blocking push/pop that record
+                        how long the calling stage stalled. A blocked stage
+                        yields briefly, then sleeps on a condition variable
+                        until the other stage pushes, pops or closes.
+                    - Close signal so the consumer knows no more items follow
+                    - Depth, capacity and high water mark accessors for tuning
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __BOUNDED_QUEUE__
+#define __BOUNDED_QUEUE__
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+using namespace std;
+
+template <class T>
+class bounded_queue {
+
+private:
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Ring buffer slots. head and tail only ever increase; slot of an index is
+    // index % capacity.
+    vector<T> slots;
+    size_t capacity;
+
+    // Next index to pop (written by consumer only)
+    atomic<size_t> head;
+
+    // Next index to push (written by producer only)
+    atomic<size_t> tail;
+
+    // Set by producer once the last item has been pushed
+    atomic<bool> closed;
+
+    // Largest number of items ever waiting in queue (written by producer only)
+    atomic<size_t> max_depth;
+
+    // Number of times a blocked stage yields before it goes to sleep
+    static const int SPIN_LIMIT = 64;
+
+    // Set while the producer sleeps waiting for room, or the consumer sleeps
+    // waiting for an item. Each only sleeps on wait_signal with wait_mutex held.
+    atomic<bool> producer_waiting;
+    atomic<bool> consumer_waiting;
+    mutex wait_mutex;
+    condition_variable wait_signal;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* void wake(const atomic<bool> &waiting);
+    Wakes the other stage if it is asleep.
+        @param      const atomic<bool> &waiting [in] whether it is asleep
+        @pre        The change it waits for (push, pop or close) has been made.
+        @post       If it was asleep, it has been signalled.
+   */
+    void wake(const atomic<bool> &waiting) {
+        // Pairs with the fence a sleeper puts between setting its flag and
+        // checking the queue one last time: either it sees the change, or
+        // this sees its flag
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiting.load(memory_order_relaxed)) {
+            lock_guard<mutex> lock(wait_mutex);
+            wait_signal.notify_all();
+        }
+    }
+
+    // Not copyable: threads hold references to the queue
+    bounded_queue(const bounded_queue &);
+    bounded_queue &operator = (const bounded_queue &);
+
+public:
+
+/******************************************************************************
+     Constructor
+******************************************************************************/
+
+    /* bounded_queue(size_t cap) throw(invalid_argument);
+    Creates a new, empty, open queue that holds at most cap items.
+        @param      size_t cap      [in] maximum number of items in queue
+        @pre        cap > 0
+        @post       An empty queue with room for cap items. Else throws
+                    invalid_argument.
+   */
+    explicit bounded_queue(size_t cap) throw(invalid_argument)
+        : slots(cap), capacity(cap), head(0), tail(0), closed(false), max_depth(0),
+          producer_waiting(false), consumer_waiting(false) {
+        if (cap == 0) {
+            throw invalid_argument("Queue capacity must be positive");
+        }
+    }
+
+/******************************************************************************
+     Producer Functions
+******************************************************************************/
+
+    /* bool try_push(T &item);
+    Moves item into the queue if there is room for it.
+        @param      T &item     [in/out] item to add. Left in a moved-from
+                                state if pushed.
+        @return     bool        [out] true if item was pushed, false if full
+        @pre        Called from the producer thread only.
+        @post       If queue was not full, item is the last item in queue.
+   */
+    bool try_push(T &item) {
+        size_t t = tail.load(memory_order_relaxed);
+        size_t h = head.load(memory_order_acquire);
+        if (t - h == capacity) {
+            return false;
+        }
+        slots[t % capacity] = std::move(item);
+        tail.store(t + 1, memory_order_release);
+
+        if (t + 1 - h > max_depth.load(memory_order_relaxed)) {
+            max_depth.store(t + 1 - h, memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /* void push(T &item, chrono::nanoseconds &stalled);
+    Moves item into the queue, waiting until there is room for it.
+        @param      T &item                     [in/out] item to add
+        @param      chrono::nanoseconds &stalled [in/out] incremented by the
+                                                time spent waiting for room
+        @pre        Called from the producer thread only. Queue is not closed.
+        @post       item is the last item in queue.
+   */
+    void push(T &item, chrono::nanoseconds &stalled) {
+        if (try_push(item)) {
+            wake(consumer_waiting);
+            return;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool pushed = false;
+        for (int spin = 0; spin < SPIN_LIMIT && !pushed; spin++) {
+            this_thread::yield();
+            pushed = try_push(item);
+        }
+        if (!pushed) {
+            unique_lock<mutex> lock(wait_mutex);
+            producer_waiting.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            while (!try_push(item)) {
+                wait_signal.wait(lock);
+            }
+            producer_waiting.store(false, memory_order_relaxed);
+        }
+        stalled += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        wake(consumer_waiting);
+    }
+
+    /* void close();
+    Tells the consumer that no more items will be pushed.
+        @pre        Called from the producer thread only.
+        @post       Queue is closed. Items already in queue can still be popped.
+   */
+    void close() {
+        closed.store(true, memory_order_release);
+        wake(consumer_waiting);
+    }
+
+/******************************************************************************
+     Consumer Functions
+******************************************************************************/
+
+    /* bool try_pop(T &item);
+    Moves the first item in the queue into item, if there is one.
+        @param      T &item     [out] popped item
+        @return     bool        [out] true if an item was popped, false if empty
+        @pre        Called from the consumer thread only.
+        @post       If queue was not empty, its first item is removed and
+                    stored in item.
+   */
+    bool try_pop(T &item) {
+        size_t h = head.load(memory_order_relaxed);
+        size_t t = tail.load(memory_order_acquire);
+        if (h == t) {
+            return false;
+        }
+        item = std::move(slots[h % capacity]);
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+
+    /* bool pop(T &item, chrono::nanoseconds &stalled);
+    Moves the first item in the queue into item, waiting until an item arrives
+    or the queue is closed.
+        @param      T &item                     [out] popped item
+        @param      chrono::nanoseconds &stalled [in/out] incremented by the
+                                                time spent waiting for an item
+        @return     bool        [out] false once the queue is closed and empty
+        @pre        Called from the consumer thread only.
+        @post       If true is returned, the first item is removed and stored
+                    in item.
+   */
+    bool pop(T &item, chrono::nanoseconds &stalled) {
+        if (try_pop(item)) {
+            wake(producer_waiting);
+            return true;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool popped = false;
+        bool asleep = false;
+        unique_lock<mutex> lock(wait_mutex, defer_lock);
+        for (int spin = 0; !(popped = try_pop(item)); spin++) {
+            if (closed.load(memory_order_acquire)) {
+                // Producer may have pushed its last item before closing
+                popped = try_pop(item);
+                break;
+            }
+            if (spin < SPIN_LIMIT) {
+                this_thread::yield();
+            }
+            else if (!asleep) {
+                // Check once more after setting the flag, before sleeping
+                lock.lock();
+                consumer_waiting.store(true, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                asleep = true;
+            }
+            else {
+                wait_signal.wait(lock);
+            }
+        }
+        if (asleep) {
+            consumer_waiting.store(false, memory_order_relaxed);
+            lock.unlock();
+        }
+        stalled += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        if (popped) {
+            wake(producer_waiting);
+        }
+        return popped;
+    }
+
+/******************************************************************************
+     Accessors
+******************************************************************************/
+
+    /* Returns number of items currently waiting in queue */
+    size_t depth() const {
+        // Read head first so a concurrent pop can't make depth negative
+        size_t h = head.load(memory_order_acquire);
+        return tail.load(memory_order_acquire) - h;
+    }
+
+    /* Returns maximum number of items queue can hold */
+    size_t get_capacity() const { return capacity; }
+
+    /* Returns largest number of items that have waited in queue at once */
+    size_t high_water_mark() const { return max_depth.load(memory_order_relaxed); }
+};
+
+#endif
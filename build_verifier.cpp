@@ -0,0 +1,359 @@
+/*****************************************************************************
+ Title:             build_verifier.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Build Verifier Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <sstream>
+#include <list>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+
+#include "build_verifier.h"
+#include "pipeline.h"
+#include "tree_serializer.h"
+
+// Most nodes per serializer task when printing with several threads. Small,
+// so that even small trees are split between threads.
+static const size_t VERIFY_GRAIN = 2;
+
+/******************************************************************************
+    Constructor
+ ******************************************************************************/
+
+build_verifier::build_verifier(unsigned long seed, size_t organisms) throw(invalid_argument)
+    : random(seed), max_organisms(organisms), inputs_checked(0), inputs_rejected(0) {
+
+    if (organisms == 0) {
+        throw invalid_argument("Verifier needs at least one organism per input");
+    }
+    thread_counts.push_back(1);
+    thread_counts.push_back(2);
+    thread_counts.push_back(4);
+}
+
+/******************************************************************************
+    Generating Inputs
+ ******************************************************************************/
+
+/* "%.9g" is enough digits for any float to be read back exactly */
+string build_verifier::format_score(float score) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.9g", (double) score);
+    return text;
+}
+
+/* Half of all inputs are small, so that short inputs with many ties are
+common. Names are made unique unless the kind calls for a clash. */
+vector<string> build_verifier::generate(input_kind kind) {
+
+    size_t limit = (random() % 2 == 0) ? min(max_organisms, (size_t) 12) : max_organisms;
+    size_t count = 1 + random() % limit;
+
+    vector<string> names;
+    set<string> used;
+    const char *syllables[] = { "ape", "hum", "mon", "tig", "lio", "ele" };
+
+    while (names.size() < count) {
+        string name;
+        if (kind == NAME_CLASH_INPUT) {
+            // Leaves named like the trees combining them would be
+            name = syllables[random() % 6];
+            if (random() % 2 == 0) {
+                name += syllables[random() % 6];
+            }
+            if (random() % 8 == 0) {
+                name = name.substr(0, 1 + random() % 2);
+            }
+            // Once the short names run out, lengthen taken ones
+            while (used.count(name) > 0 && used.size() >= 24) {
+                name += (char) ('a' + random() % 26);
+            }
+        }
+        else {
+            size_t length = 1 + random() % 6;
+            for (size_t i = 0; i < length; i++) {
+                name += (char) ('a' + random() % 26);
+            }
+        }
+        if (used.insert(name).second) {
+            names.push_back(name);
+        }
+    }
+
+    vector<float> scores;
+    if (kind == TIED_INPUT) {
+        // Points of a grid, so many gaps are equal and averages land on it
+        const float steps[] = { 1.0f, 0.5f, 0.25f, 3.0f, 1024.0f, 0.1f };
+        float step = steps[random() % 6];
+        float base = (random() % 100) * step;
+        vector<size_t> grid;
+        for (size_t k = 0; k < 2 * count; k++) {
+            grid.push_back(k);
+        }
+        shuffle(grid.begin(), grid.end(), random);
+        for (size_t i = 0; i < count; i++) {
+            scores.push_back(base + grid[i] * step);
+        }
+    }
+    else if (kind == FLOAT_EDGE_INPUT) {
+        // Runs of neighbouring floats, from subnormal to nearly the largest
+        // float, where averaging rounds or overflows
+        const float starts[] = { 1e-40f, 1.17549435e-38f, 1.0f, 16777216.0f, 1e30f, 3.0e38f };
+        float score = starts[random() % 6];
+        for (size_t i = 0; i < count; i++) {
+            scores.push_back(score);
+            size_t steps = 1 + random() % 3;
+            if (random() % 5 == 0) {
+                score = min(score * (1.0f + (random() % 100) / 50.0f), FLT_MAX);
+            }
+            for (size_t k = 0; k < steps; k++) {
+                score = nextafterf(score, FLT_MAX);
+            }
+        }
+        shuffle(scores.begin(), scores.end(), random);
+    }
+    else {
+        uniform_real_distribution<float> uniform(0.0f, 1000.0f);
+        for (size_t i = 0; i < count; i++) {
+            scores.push_back(uniform(random));
+        }
+    }
+
+    if (kind == DUPLICATE_INPUT && count >= 2) {
+        size_t from = random() % count, to = random() % count;
+        if (from == to) {
+            to = (to + 1) % count;
+        }
+        if (random() % 2 == 0) {
+            names[to] = names[from];
+        }
+        else {
+            scores[to] = scores[from];
+        }
+    }
+
+    vector<string> lines;
+    for (size_t i = 0; i < count; i++) {
+        // Scores below zero are not valid organisms
+        lines.push_back(names[i] + " " + format_score(fabs(scores[i])));
+    }
+    return lines;
+}
+
+/******************************************************************************
+    Building and Comparing
+ ******************************************************************************/
+
+/* Lines that are not valid organisms are skipped, as the pipeline skips them.
+The pipeline gets tiny queues and batches so that its stages interleave. */
+build_verifier::build_outcome build_verifier::build(const vector<string> &lines, build_engine engine,
+                                                    bool through_pipeline) const {
+    build_outcome outcome;
+    try {
+        if (through_pipeline) {
+            ostringstream text;
+            for (size_t i = 0; i < lines.size(); i++) {
+                text << lines[i] << "\n";
+            }
+            istringstream in(text.str());
+
+            organism_pipeline pipeline(2, 3, 16);
+            pipeline.build_with(engine);
+            outcome.tree = pipeline.build(in);
+        }
+        else {
+            list<binary_tree> trees;
+            for (size_t i = 0; i < lines.size(); i++) {
+                try {
+                    trees.push_back(binary_tree(lines[i]));
+                }
+                catch (invalid_argument &ia) {
+                    // Not an organism
+                }
+            }
+            outcome.tree = binary_tree(trees, engine);
+        }
+    }
+    catch (invalid_argument &ia) {
+        outcome.failed = true;
+        outcome.error = ia.what();
+    }
+    return outcome;
+}
+
+/* The oracle is the reference engine building from a list and printed with
+operator <<, or, in Newick format, by a single thread. */
+build_verifier::oracle_outcome build_verifier::build_oracle(const vector<string> &lines) const {
+
+    oracle_outcome oracle;
+    oracle.built = build(lines, REFERENCE_ENGINE, false);
+
+    if (!oracle.built.failed) {
+        ostringstream printed;
+        printed << oracle.built.tree;
+        oracle.paren = printed.str();
+        oracle.paren.erase(oracle.paren.size() - 1);
+        oracle.newick = tree_serializer(oracle.built.tree, NEWICK_FORMAT).str();
+        oracle.score = oracle.built.tree.pre_order().begin()->get_score();
+    }
+    return oracle;
+}
+
+/* Every engine and path must throw the same exception or build a tree with the
+same root score, bit for bit, that prints the same with every number of
+threads. The reference engine building from a list is the oracle's own tree,
+so only its printing by several threads is checked. */
+bool build_verifier::agree(const vector<string> &lines, const oracle_outcome &oracle,
+                           string &difference) const {
+
+    const build_engine engines[] = { REFERENCE_ENGINE, SORTED_ENGINE };
+    const char *engine_names[] = { "reference engine", "sorted engine" };
+
+    for (int e = 0; e < 2; e++) {
+        for (int path = 0; path < 2; path++) {
+            build_outcome rebuilt;
+            if (e != 0 || path != 0) {
+                rebuilt = build(lines, engines[e], path == 1);
+            }
+            const build_outcome &outcome = (e == 0 && path == 0) ? oracle.built : rebuilt;
+            string how = string(engine_names[e]) + (path == 1 ? " through pipeline" : " from list");
+
+            if (outcome.failed != oracle.built.failed || outcome.error != oracle.built.error) {
+                difference = how + ": "
+                    + (outcome.failed ? "threw '" + outcome.error + "'" : string("built a tree"))
+                    + ", expected "
+                    + (oracle.built.failed ? "'" + oracle.built.error + "'" : string("a tree"));
+                return false;
+            }
+            if (outcome.failed) {
+                continue;
+            }
+
+            float score = outcome.tree.pre_order().begin()->get_score();
+            if (memcmp(&score, &oracle.score, sizeof(float)) != 0) {
+                difference = how + ": root score " + format_score(score)
+                    + ", expected " + format_score(oracle.score);
+                return false;
+            }
+
+            for (size_t t = 0; t < thread_counts.size(); t++) {
+                ostringstream threads;
+                threads << ", " << thread_counts[t] << " thread(s)";
+
+                string paren = tree_serializer(outcome.tree, PAREN_FORMAT, thread_counts[t], NULL, VERIFY_GRAIN).str();
+                if (paren != oracle.paren) {
+                    difference = how + threads.str() + ": printed\n    " + paren
+                        + "\n  expected\n    " + oracle.paren;
+                    return false;
+                }
+
+                string newick = tree_serializer(outcome.tree, NEWICK_FORMAT, thread_counts[t], NULL, VERIFY_GRAIN).str();
+                if (newick != oracle.newick) {
+                    difference = how + threads.str() + ": printed Newick\n    " + newick
+                        + "\n  expected\n    " + oracle.newick;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/* Splits the input into parts and tries leaving out each part in turn. If the
+builds still disagree without a part, that part is dropped for good and the
+parts are made a little larger again; if no part can be left out, the parts are
+halved. Stops once no single line can be left out. */
+vector<string> build_verifier::minimize(const vector<string> &lines) const {
+
+    vector<string> current = lines;
+    size_t parts = 2;
+    string difference;
+
+    while (current.size() >= 2) {
+        size_t part_size = (current.size() + parts - 1) / parts;
+        bool reduced = false;
+
+        for (size_t start = 0; start < current.size(); start += part_size) {
+            vector<string> rest(current.begin(), current.begin() + start);
+            rest.insert(rest.end(), current.begin() + min(start + part_size, current.size()), current.end());
+
+            if (!agree(rest, build_oracle(rest), difference)) {
+                current = rest;
+                parts = max(parts - 1, (size_t) 2);
+                reduced = true;
+                break;
+            }
+        }
+
+        if (!reduced) {
+            if (parts >= current.size()) {
+                break;
+            }
+            parts = min(parts * 2, current.size());
+        }
+    }
+    return current;
+}
+
+/******************************************************************************
+    Checking
+ ******************************************************************************/
+
+bool build_verifier::check(const vector<string> &lines, ostream &report) {
+
+    string difference;
+    inputs_checked++;
+    oracle_outcome oracle = build_oracle(lines);
+    if (agree(lines, oracle, difference)) {
+        if (oracle.built.failed) {
+            inputs_rejected++;
+        }
+        return true;
+    }
+
+    report << "MISMATCH on input of " << lines.size() << " organisms" << endl;
+    report << "  " << difference << endl;
+
+    vector<string> smallest = minimize(lines);
+    agree(smallest, build_oracle(smallest), difference);
+    report << "Minimized to " << smallest.size() << " organisms:" << endl;
+    for (size_t i = 0; i < smallest.size(); i++) {
+        report << "    " << smallest[i] << endl;
+    }
+    report << "  " << difference << endl;
+    return false;
+}
+
+bool build_verifier::run(size_t cases, ostream &report) {
+
+    const char *kind_names[] = { "random", "tied", "float edge", "duplicate", "name clash" };
+    size_t per_kind[INPUT_KINDS] = { 0 };
+
+    for (size_t i = 0; i < cases; i++) {
+        input_kind kind = (input_kind) (i % INPUT_KINDS);
+        vector<string> lines = generate(kind);
+        per_kind[kind]++;
+
+        if (!check(lines, report)) {
+            report << "Input was " << kind_names[kind] << " case " << i + 1 << " of " << cases << endl;
+            return false;
+        }
+    }
+
+    report << "Verified " << inputs_checked << " inputs (";
+    for (int k = 0; k < INPUT_KINDS; k++) {
+        report << (k > 0 ? ", " : "") << per_kind[k] << " " << kind_names[k];
+    }
+    report << "), " << inputs_rejected << " rejected by every build" << endl;
+    report << "Every engine, build path and thread count matched the reference" << endl;
+    return true;
+}
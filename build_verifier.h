@@ -0,0 +1,204 @@
+/*****************************************************************************
+ Title:             build_verifier.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Build Verifier Class Definition (Header File)
+                    - Checks that every way of building and printing a tree
+                        gives exactly the tree built by the original search
+                        over every pair of trees, which serves as the oracle:
+                        - both build engines
+                        - building from a list and through the pipeline
+                        - printing with one and with several threads
+                    - Compares the exception thrown, the root score, and the
+                        printed tree in both formats
+                    - Generates random and adversarial inputs: tied gaps,
+                        scores one float apart or too large to average,
+                        duplicate names and scores, and names that clash with
+                        the names given to combined trees
+                    - Shrinks any input the builds disagree on to a small
+                        input that still shows the difference
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __BUILD_VERIFIER__
+#define __BUILD_VERIFIER__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+class build_verifier {
+
+private:
+
+/******************************************************************************
+     Private types
+******************************************************************************/
+
+    // Kinds of generated input
+    enum input_kind {
+        RANDOM_INPUT,           // distinct names and scores
+        TIED_INPUT,             // scores on an evenly spaced grid
+        FLOAT_EDGE_INPUT,       // scores a float or two apart, at every scale
+        DUPLICATE_INPUT,        // one name or score given twice
+        NAME_CLASH_INPUT,       // names like "ape", "hum" and "apehum"
+        INPUT_KINDS
+    };
+
+    // Result of building one input one way
+    struct build_outcome {
+        bool failed;
+        string error;       // what() of the exception thrown, if failed
+        binary_tree tree;   // tree built, if not failed
+        build_outcome() : failed(false) {}
+    };
+
+    // What every build of one input must match: the oracle's outcome, and
+    // its tree printed in both formats
+    struct oracle_outcome {
+        build_outcome built;
+        string paren;       // printed with operator <<, without the newline
+        string newick;      // printed in Newick format by one thread
+        float score;        // root score
+        oracle_outcome() : score(0) {}
+    };
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    mt19937 random;
+
+    // Largest number of organisms in a generated input. The oracle takes
+    // O(n^3) time, so inputs are kept small.
+    size_t max_organisms;
+
+    // Numbers of threads each tree is printed with
+    vector<size_t> thread_counts;
+
+    // Inputs checked, and how many of them every build rejected
+    size_t inputs_checked;
+    size_t inputs_rejected;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* vector<string> generate(input_kind kind);
+    Generates an input of the given kind.
+        @param      input_kind kind     [in] kind of input
+        @return     vector<string>      [out] lines of "name score"
+        @pre        None.
+        @post       Random number generator has advanced.
+   */
+    vector<string> generate(input_kind kind);
+
+    /* build_outcome build(const vector<string> &lines, build_engine engine, bool through_pipeline) const;
+    Builds a tree from lines, skipping lines that are not valid organisms.
+        @param      const vector<string> &lines [in] input lines
+        @param      build_engine engine         [in] engine to build with
+        @param      bool through_pipeline       [in] build with the concurrent
+                                                pipeline rather than from a
+                                                list
+        @return     build_outcome               [out] tree, or the exception
+        @pre        None.
+        @post       None.
+   */
+    build_outcome build(const vector<string> &lines, build_engine engine, bool through_pipeline) const;
+
+    /* oracle_outcome build_oracle(const vector<string> &lines) const;
+    Builds lines with the reference engine from a list and prints the tree.
+        @param      const vector<string> &lines [in] input lines
+        @return     oracle_outcome      [out] outcome every build must match
+        @pre        None.
+        @post       None.
+   */
+    oracle_outcome build_oracle(const vector<string> &lines) const;
+
+    /* bool agree(const vector<string> &lines, const oracle_outcome &oracle, string &difference) const;
+    Builds lines every other way and compares each result with the oracle.
+        @param      const vector<string> &lines [in] input lines
+        @param      const oracle_outcome &oracle [in] build_oracle(lines)
+        @param      string &difference  [out] first difference found
+        @return     bool                [out] true if every build agrees
+        @pre        oracle was built from lines.
+        @post       None.
+   */
+    bool agree(const vector<string> &lines, const oracle_outcome &oracle, string &difference) const;
+
+    /* vector<string> minimize(const vector<string> &lines) const;
+    Removes as many lines as it can while the builds still disagree, trying
+    to remove large blocks of lines first and smaller ones after (delta
+    debugging).
+        @param      const vector<string> &lines [in] input the builds
+                                                disagree on
+        @return     vector<string>              [out] input the builds still
+                                                disagree on, from which no
+                                                single line can be removed
+        @pre        The builds of lines disagree.
+        @post       None.
+   */
+    vector<string> minimize(const vector<string> &lines) const;
+
+    /* static string format_score(float score);
+    Prints a score with enough digits to be read back as the same float.
+        @param      float score     [in] score
+        @return     string          [out] score as text
+        @pre        None.
+        @post       None.
+   */
+    static string format_score(float score);
+
+public:
+
+/******************************************************************************
+     Public Constructor
+******************************************************************************/
+
+    /* build_verifier(unsigned long seed, size_t organisms = 80) throw(invalid_argument);
+    Creates a verifier whose inputs are generated from seed.
+        @param      unsigned long seed  [in] seed for generated inputs
+        @param      size_t organisms    [in] most organisms per generated input
+        @pre        organisms is positive.
+        @post       A verifier that has checked no inputs. Else throws
+                    invalid_argument.
+   */
+    build_verifier(unsigned long seed, size_t organisms = 80) throw(invalid_argument);
+
+/******************************************************************************
+     Public Functions
+******************************************************************************/
+
+    /* bool check(const vector<string> &lines, ostream &report);
+    Checks that every build of lines agrees with the oracle.
+        @param      const vector<string> &lines [in] input lines
+        @param      ostream &report     [in/out] stream to report failure to
+        @return     bool                [out] true if every build agrees
+        @pre        None.
+        @post       On failure, the first difference and a minimized input
+                    are written to report.
+   */
+    bool check(const vector<string> &lines, ostream &report);
+
+    /* bool run(size_t cases, ostream &report);
+    Generates cases inputs, cycling through every kind, and checks each.
+        @param      size_t cases        [in] number of inputs to check
+        @param      ostream &report     [in/out] stream to report to
+        @return     bool                [out] true if every input agrees
+        @pre        None.
+        @post       Stops at the first input the builds disagree on. Writes a
+                    summary to report.
+   */
+    bool run(size_t cases, ostream &report);
+};
+
+#endif
@@ -0,0 +1,240 @@
+/*****************************************************************************
+ Title:             dendrogram_index.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Dendrogram Index Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "dendrogram_index.h"
+
+/******************************************************************************
+    Constructor
+ ******************************************************************************/
+
+/* Orders merges by height, highest first. Ties go to the merge nearer the root
+so that undoing any prefix of the order never splits a subtree whose parent is
+still joined. */
+struct higher_merge {
+    const vector<float> *heights;
+    const vector<int> *depths;
+    bool operator () (int a, int b) const {
+        if ((*heights)[a] != (*heights)[b]) {
+            return (*heights)[a] > (*heights)[b];
+        }
+        return (*depths)[a] < (*depths)[b];
+    }
+};
+
+/* Walks the tree without recursion, numbering nodes in pre-order and keeping
+each node's children and depth. A reverse pass over the pre-order numbering
+visits children before parents and raises each node's height to the largest
+height below it. An in-order pass then alternates between leaves and internal
+nodes: each internal node lies between the last leaf of its left subtree and
+the first leaf of its right subtree, so its height is the gap between those two
+neighbouring leaves.
+*/
+dendrogram_index::dendrogram_index(const binary_tree &tree) throw(invalid_argument, bad_alloc) {
+
+    tree_node *root = tree.get_root_ptr();
+    if (root == NULL) {
+        throw invalid_argument("Empty tree");
+    }
+
+    // Pre-order numbering of nodes
+    vector<tree_node *> nodes;
+    vector<int> left_child, right_child, depth;
+
+    // Stack of (node, index of parent, is right child of parent)
+    vector<pair<tree_node *, pair<int, bool> > > stack;
+    stack.push_back(make_pair(root, make_pair(-1, false)));
+
+    while (!stack.empty()) {
+        tree_node *tn_ptr = stack.back().first;
+        int parent = stack.back().second.first;
+        bool is_right = stack.back().second.second;
+        stack.pop_back();
+
+        int idx = nodes.size();
+        nodes.push_back(tn_ptr);
+        left_child.push_back(-1);
+        right_child.push_back(-1);
+        depth.push_back(parent < 0 ? 0 : depth[parent] + 1);
+
+        if (parent >= 0) {
+            if (is_right) {
+                right_child[parent] = idx;
+            }
+            else {
+                left_child[parent] = idx;
+            }
+        }
+
+        if (tn_ptr->left != NULL && tn_ptr->right != NULL) {
+            stack.push_back(make_pair(tn_ptr->right, make_pair(idx, true)));
+            stack.push_back(make_pair(tn_ptr->left, make_pair(idx, false)));
+        }
+        else if (tn_ptr->left != NULL || tn_ptr->right != NULL) {
+            throw invalid_argument("Tree has a node with a single child");
+        }
+    }
+
+    // Monotone merge heights: children are numbered after their parents
+    vector<float> height(nodes.size());
+    for (int i = nodes.size() - 1; i >= 0; i--) {
+        height[i] = nodes[i]->height;
+        if (left_child[i] >= 0) {
+            height[i] = max(height[i], max(height[left_child[i]], height[right_child[i]]));
+        }
+    }
+
+    // In-order pass: leaves and the gaps between them
+    vector<int> gap_depth;
+    vector<int> in_order;
+    int current = 0;
+    while (current >= 0 || !in_order.empty()) {
+        if (current >= 0) {
+            in_order.push_back(current);
+            current = left_child[current];
+        }
+        else {
+            int idx = in_order.back();
+            in_order.pop_back();
+            if (left_child[idx] < 0) {
+                leaf_names.push_back(nodes[idx]->name);
+            }
+            else {
+                gaps.push_back(height[idx]);
+                gap_depth.push_back(depth[idx]);
+            }
+            current = right_child[idx];
+        }
+    }
+
+    // Merge order
+    merge_order.resize(gaps.size());
+    for (size_t i = 0; i < gaps.size(); i++) {
+        merge_order[i] = i;
+    }
+    higher_merge cmp;
+    cmp.heights = &gaps;
+    cmp.depths = &gap_depth;
+    sort(merge_order.begin(), merge_order.end(), cmp);
+
+    // Name lookup
+    positions.resize(leaf_names.size());
+    for (size_t i = 0; i < leaf_names.size(); i++) {
+        positions[i] = make_pair(leaf_names[i], (int) i);
+    }
+    sort(positions.begin(), positions.end());
+
+    build_range_maxima();
+}
+
+/* Doubles the length of the ranges covered at each level: the maximum of a
+range of 2^k gaps is the larger of the maxima of its two halves. */
+void dendrogram_index::build_range_maxima() {
+
+    max_gap.clear();
+    max_gap.push_back(gaps);
+
+    for (size_t len = 2; len <= gaps.size(); len *= 2) {
+        const vector<float> &prev = max_gap.back();
+        vector<float> level(gaps.size() - len + 1);
+        for (size_t i = 0; i < level.size(); i++) {
+            level[i] = max(prev[i], prev[i + len / 2]);
+        }
+        max_gap.push_back(level);
+    }
+}
+
+/******************************************************************************
+    Accessors
+ ******************************************************************************/
+
+/* Returns the number of organisms (leaves) in the tree */
+size_t dendrogram_index::size() const { return leaf_names.size(); }
+
+/* Returns the organism names in the order they are printed */
+const vector<string> &dendrogram_index::names() const { return leaf_names; }
+
+/******************************************************************************
+    Queries
+ ******************************************************************************/
+
+/* Scans the gaps from left to right, starting a new cluster after every gap
+that is above the threshold. */
+vector<int> dendrogram_index::cut(float max_gap_allowed) const {
+
+    vector<int> labels(leaf_names.size());
+    int start = 0;
+    for (size_t i = 0; i < labels.size(); i++) {
+        if (i > 0 && gaps[i - 1] > max_gap_allowed) {
+            start = i;
+        }
+        labels[i] = start;
+    }
+    return labels;
+}
+
+/* Marks the first k-1 merges in merge order as undone, then scans the gaps as
+cut() does, starting a new cluster after every undone merge. */
+vector<int> dendrogram_index::top_clusters(size_t k) const {
+
+    if (k < 1) {
+        k = 1;
+    }
+    if (k > leaf_names.size()) {
+        k = leaf_names.size();
+    }
+
+    vector<bool> undone(gaps.size(), false);
+    for (size_t i = 0; i + 1 < k; i++) {
+        undone[merge_order[i]] = true;
+    }
+
+    vector<int> labels(leaf_names.size());
+    int start = 0;
+    for (size_t i = 0; i < labels.size(); i++) {
+        if (i > 0 && undone[i - 1]) {
+            start = i;
+        }
+        labels[i] = start;
+    }
+    return labels;
+}
+
+/* Moves the start of the cluster left from pos in steps of decreasing powers of
+two, taking each step only if no gap it crosses is above the threshold. */
+int dendrogram_index::cluster_start(int pos, float max_gap_allowed) const {
+
+    int start = pos;
+    for (int k = max_gap.size() - 1; k >= 0; k--) {
+        int len = 1 << k;
+        // Gaps crossed moving from start to start - len are
+        // gaps[start - len .. start - 1]
+        if (start - len >= 0 && max_gap[k][start - len] <= max_gap_allowed) {
+            start -= len;
+        }
+    }
+    return start;
+}
+
+/* Finds the organism's leaf position by binary search on its name, then finds
+the first leaf of its cluster. */
+int dendrogram_index::cluster_of(const string &name, float max_gap_allowed) const throw(invalid_argument) {
+
+    vector<pair<string, int> >::const_iterator it;
+    it = lower_bound(positions.begin(), positions.end(), make_pair(name, -1));
+
+    if (it == positions.end() || it->first != name) {
+        string reason = "'" + name + "' is not an organism in the tree";
+        throw invalid_argument(reason);
+    }
+
+    return cluster_start(it->second, max_gap_allowed);
+}
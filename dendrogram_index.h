@@ -0,0 +1,153 @@
+/*****************************************************************************
+ Title:             dendrogram_index.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Dendrogram Index Class Definition (Header File)
+                    - Constructor that walks a finished binary tree once and
+                        precomputes, in merge order, the clusters it forms at
+                        every merge height
+                    - Threshold cuts: clusters of organisms whose merge gaps
+                        are all <= d, in O(n)
+                    - Top-k cuts: the k clusters left after undoing the k-1
+                        highest merges, in O(n)
+                    - Cluster of a single organism at a given gap, in O(log n)
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __DENDROGRAM_INDEX__
+#define __DENDROGRAM_INDEX__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+/* Clusters are labelled by the leaf position of their first organism, so the
+same group has the same label whichever query produced it. Leaf positions
+follow the order organisms are printed in by operator <<. */
+
+class dendrogram_index {
+
+private:
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Organism names in leaf order
+    vector<string> leaf_names;
+
+    // gaps[i] is the merge height at which leaves i and i+1 were first joined,
+    // i.e. the height of their lowest common ancestor. Heights are made
+    // monotone up the tree (a node's height is at least that of its children)
+    // so that every cut is a valid set of subtrees.
+    vector<float> gaps;
+
+    // Indices into gaps, highest merge first. Of two merges at the same
+    // height the one nearer the root comes first.
+    vector<int> merge_order;
+
+    // max_gap[k][i] is the largest of gaps[i .. i+2^k-1]
+    vector<vector<float> > max_gap;
+
+    // (name, leaf position) pairs sorted by name
+    vector<pair<string, int> > positions;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* void build_range_maxima();
+    Fills max_gap from gaps.
+        @pre        gaps is initialized.
+        @post       max_gap[k][i] holds the maximum of the 2^k gaps starting
+                    at i, for every range that fits inside gaps.
+   */
+    void build_range_maxima();
+
+    /* int cluster_start(int pos, float max_gap_allowed) const;
+    Returns the leaf position of the first organism in pos's cluster.
+        @param      int pos                 [in] leaf position of organism
+        @param      float max_gap_allowed   [in] threshold of the cut
+        @return     int                     [out] first leaf of pos's cluster
+        @pre        0 <= pos < number of leaves
+        @post       Returns the smallest j <= pos such that no gap between j
+                    and pos is > max_gap_allowed.
+   */
+    int cluster_start(int pos, float max_gap_allowed) const;
+
+public:
+
+/******************************************************************************
+     Public Constructor
+******************************************************************************/
+
+    /* dendrogram_index(const binary_tree &tree) throw(invalid_argument, bad_alloc);
+    Walks tree once, recording its leaves in print order and the merge height
+    between every pair of neighbouring leaves, then sorts the merges by height.
+        @param      const binary_tree &tree     [in] finished organism tree
+        @pre        tree is non-empty and every internal node has two children
+        @post       An index that answers cuts of tree. tree is unchanged and
+                    may be destroyed. Else throws invalid_argument.
+   */
+    dendrogram_index(const binary_tree &tree) throw(invalid_argument, bad_alloc);
+
+/******************************************************************************
+     Public Accessors
+******************************************************************************/
+
+    /* Returns the number of organisms in the tree */
+    size_t size() const;
+
+    /* Returns the organism names in leaf order */
+    const vector<string> &names() const;
+
+/******************************************************************************
+     Public Queries
+******************************************************************************/
+
+    /* vector<int> cut(float max_gap_allowed) const;
+    Groups organisms that were joined by merges whose gaps are all <= max_gap.
+        @param      float max_gap_allowed   [in] largest merge gap inside a
+                                            cluster
+        @return     vector<int>             [out] cluster label of each
+                                            organism, in leaf order
+        @pre        None.
+        @post       Organisms at positions i and j share a label iff every
+                    merge on the path between them has gap <= max_gap_allowed.
+                    Runs in O(n).
+   */
+    vector<int> cut(float max_gap_allowed) const;
+
+    /* vector<int> top_clusters(size_t k) const;
+    Splits organisms into k clusters by undoing the k-1 highest merges.
+        @param      size_t k        [in] number of clusters wanted
+        @return     vector<int>     [out] cluster label of each organism, in
+                                    leaf order
+        @pre        None. k is clamped to [1, number of organisms].
+        @post       Exactly k distinct labels are returned. Runs in O(n).
+   */
+    vector<int> top_clusters(size_t k) const;
+
+    /* int cluster_of(const string &name, float max_gap_allowed) const throw(invalid_argument);
+    Returns the label of the cluster containing organism name in
+    cut(max_gap_allowed), without computing the whole cut.
+        @param      const string &name      [in] name of organism
+        @param      float max_gap_allowed   [in] largest merge gap inside a
+                                            cluster
+        @return     int                     [out] label of name's cluster
+        @pre        name is the name of a leaf in the tree.
+        @post       Returns cut(max_gap_allowed)[position of name] in
+                    O(log n). Else throws invalid_argument.
+   */
+    int cluster_of(const string &name, float max_gap_allowed) const throw(invalid_argument);
+};
+
+#endif
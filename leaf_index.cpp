@@ -0,0 +1,249 @@
+/*****************************************************************************
+ Title:             leaf_index.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Leaf Index and Leaf Range Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#include "leaf_index.h"
+
+// Number of queries a thread takes at a time from a batch
+static const size_t QUERY_BLOCK = 64;
+
+/******************************************************************************
+    Leaf Range
+ ******************************************************************************/
+
+leaf_range::leaf_range(const_iterator b, const_iterator e) : first(b), last(e) {}
+
+leaf_range::const_iterator leaf_range::begin() const { return first; }
+
+leaf_range::const_iterator leaf_range::end() const { return last; }
+
+size_t leaf_range::size() const { return last - first; }
+
+ostream & operator << (ostream &os, const leaf_range &range) {
+    for (leaf_range::const_iterator it = range.begin(); it != range.end(); ++it) {
+        if (it != range.begin()) {
+            os << ", ";
+        }
+        os << (*it)->get_name() << " " << (*it)->get_score();
+    }
+    return os;
+}
+
+/******************************************************************************
+    Constructor
+ ******************************************************************************/
+
+/* Orders leaves by increasing score */
+static bool lower_score(const tree_node *a, const tree_node *b) {
+    return a->get_score() < b->get_score();
+}
+
+/* Because every subtree covers a contiguous range of scores, the leaves of a
+node are next to each other once all leaves are sorted by score. A leaf's span
+is its own position; a post-order walk reaches both children of an internal
+node before the node itself, and the node's span runs from the start of its
+lower child's span to the end of its higher one. The spans are checked to be
+exactly as long as the number of leaves they should hold.
+*/
+leaf_index::leaf_index(const binary_tree &t) throw(invalid_argument, bad_alloc) : tree(t) {
+
+    tree_range leaves = tree.leaves();
+    for (tree_iterator it = leaves.begin(); it != leaves.end(); ++it) {
+        sorted_leaves.push_back(&*it);
+    }
+    sort(sorted_leaves.begin(), sorted_leaves.end(), lower_score);
+
+    for (size_t i = 0; i < sorted_leaves.size(); i++) {
+        ranges[sorted_leaves[i]] = make_pair(i, i + 1);
+    }
+
+    tree_range nodes = tree.post_order();
+    for (tree_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        if (it->is_leaf()) {
+            continue;
+        }
+
+        const pair<size_t, size_t> &left_span = ranges[it->get_left()];
+        const pair<size_t, size_t> &right_span = ranges[it->get_right()];
+
+        pair<size_t, size_t> span(min(left_span.first, right_span.first),
+                                  max(left_span.second, right_span.second));
+
+        size_t leaf_count = (left_span.second - left_span.first) + (right_span.second - right_span.first);
+        if (span.second - span.first != leaf_count) {
+            throw invalid_argument("Subtree '" + it->get_name() + "' does not cover a contiguous range of scores");
+        }
+
+        ranges[&*it] = span;
+    }
+}
+
+/******************************************************************************
+    Accessors
+ ******************************************************************************/
+
+size_t leaf_index::size() const { return sorted_leaves.size(); }
+
+const vector<const tree_node *> &leaf_index::sorted() const { return sorted_leaves; }
+
+const binary_tree &leaf_index::indexed_tree() const { return tree; }
+
+/* Looks up the node's span and returns that slice of the sorted leaves */
+leaf_range leaf_index::leaves_under(const tree_node &node) const throw(invalid_argument) {
+
+    unordered_map<const tree_node *, pair<size_t, size_t> >::const_iterator found = ranges.find(&node);
+    if (found == ranges.end()) {
+        throw invalid_argument("'" + node.get_name() + "' is not a node of the indexed tree");
+    }
+
+    return leaf_range(sorted_leaves.begin() + found->second.first,
+                      sorted_leaves.begin() + found->second.second);
+}
+
+/******************************************************************************
+    Score Queries
+ ******************************************************************************/
+
+/* Orders a leaf before a score it is lower than */
+static bool score_below(const tree_node *leaf, float score) {
+    return leaf->get_score() < score;
+}
+
+/* Orders a score before a leaf it is lower than */
+static bool score_above(float score, const tree_node *leaf) {
+    return score < leaf->get_score();
+}
+
+/* Two binary searches find the first leaf not below low and the first leaf
+above high */
+leaf_range leaf_index::scores_between(float low, float high) const throw(invalid_argument) {
+
+    // Also false if either bound is NaN
+    if (!(low <= high)) {
+        throw invalid_argument("Lowest score of a range must not be above its highest");
+    }
+
+    vector<const tree_node *>::const_iterator first =
+        lower_bound(sorted_leaves.begin(), sorted_leaves.end(), low, score_below);
+    vector<const tree_node *>::const_iterator last =
+        upper_bound(first, sorted_leaves.end(), high, score_above);
+
+    return leaf_range(first, last);
+}
+
+/* Finds where score would go among the sorted leaves, then grows a window
+from there one leaf at a time, taking whichever leaf just outside it is closer
+to score, until it holds k leaves. */
+leaf_range leaf_index::nearest(float score, size_t k) const throw(invalid_argument) {
+
+    if (score != score) {
+        throw invalid_argument("Score to search around must be a number");
+    }
+
+    size_t n = sorted_leaves.size();
+    size_t middle = lower_bound(sorted_leaves.begin(), sorted_leaves.end(), score, score_below)
+                    - sorted_leaves.begin();
+    size_t low = middle, high = middle;
+    k = min(k, n);
+
+    while (high - low < k) {
+        if (low == 0) {
+            high++;
+        }
+        else if (high == n) {
+            low--;
+        }
+        else if (score - sorted_leaves[low - 1]->get_score() <= sorted_leaves[high]->get_score() - score) {
+            low--;
+        }
+        else {
+            high++;
+        }
+    }
+
+    return leaf_range(sorted_leaves.begin() + low, sorted_leaves.begin() + high);
+}
+
+/* Checks every query first, so that a bad one throws before any thread
+starts. The calling thread answers blocks too. */
+vector<leaf_range> leaf_index::scores_between(const vector<score_range_query> &queries, size_t threads) const throw(invalid_argument, bad_alloc) {
+
+    if (threads == 0) {
+        throw invalid_argument("Queries need at least one thread");
+    }
+    for (size_t i = 0; i < queries.size(); i++) {
+        if (!(queries[i].low <= queries[i].high)) {
+            throw invalid_argument("Lowest score of a range must not be above its highest");
+        }
+    }
+
+    vector<leaf_range> results(queries.size(), leaf_range(sorted_leaves.end(), sorted_leaves.end()));
+    atomic<size_t> next(0);
+
+    vector<thread> helpers;
+    for (size_t i = 1; i < threads && i * QUERY_BLOCK < queries.size(); i++) {
+        helpers.push_back(thread(&leaf_index::range_worker, this, cref(queries), ref(results), ref(next)));
+    }
+    range_worker(queries, results, next);
+    for (size_t i = 0; i < helpers.size(); i++) {
+        helpers[i].join();
+    }
+    return results;
+}
+
+vector<leaf_range> leaf_index::nearest(const vector<nearest_query> &queries, size_t threads) const throw(invalid_argument, bad_alloc) {
+
+    if (threads == 0) {
+        throw invalid_argument("Queries need at least one thread");
+    }
+    for (size_t i = 0; i < queries.size(); i++) {
+        if (queries[i].score != queries[i].score) {
+            throw invalid_argument("Score to search around must be a number");
+        }
+    }
+
+    vector<leaf_range> results(queries.size(), leaf_range(sorted_leaves.end(), sorted_leaves.end()));
+    atomic<size_t> next(0);
+
+    vector<thread> helpers;
+    for (size_t i = 1; i < threads && i * QUERY_BLOCK < queries.size(); i++) {
+        helpers.push_back(thread(&leaf_index::nearest_worker, this, cref(queries), ref(results), ref(next)));
+    }
+    nearest_worker(queries, results, next);
+    for (size_t i = 0; i < helpers.size(); i++) {
+        helpers[i].join();
+    }
+    return results;
+}
+
+/* Each thread writes only the answers to the blocks it took, and the index
+itself is only read, so no locking is needed. */
+void leaf_index::range_worker(const vector<score_range_query> &queries, vector<leaf_range> &results, atomic<size_t> &next) const {
+    size_t first;
+    while ((first = next.fetch_add(QUERY_BLOCK)) < queries.size()) {
+        size_t last = min(first + QUERY_BLOCK, queries.size());
+        for (size_t i = first; i < last; i++) {
+            results[i] = scores_between(queries[i].low, queries[i].high);
+        }
+    }
+}
+
+void leaf_index::nearest_worker(const vector<nearest_query> &queries, vector<leaf_range> &results, atomic<size_t> &next) const {
+    size_t first;
+    while ((first = next.fetch_add(QUERY_BLOCK)) < queries.size()) {
+        size_t last = min(first + QUERY_BLOCK, queries.size());
+        for (size_t i = first; i < last; i++) {
+            results[i] = nearest(queries[i].score, queries[i].k);
+        }
+    }
+}
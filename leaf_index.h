@@ -0,0 +1,207 @@
+/*****************************************************************************
+ Title:             leaf_index.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Leaf Index and Leaf Range Class Definitions (Header File)
+                    - Constructor that lays out the leaves of a tree in one
+                        array sorted by score and records, for every node, the
+                        slice of the array its leaves occupy
+                    - Leaf range of any node, score ordered, in O(1) plus the
+                        number of leaves read
+                    - Leaves with scores between two bounds, in O(log n) plus
+                        the number of leaves read, and the k leaves closest in
+                        score to a given score, in O(log n + k)
+                    - Batches of either query answered by several threads
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __LEAF_INDEX__
+#define __LEAF_INDEX__
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+/* The leaves below a single node, in increasing order of score. Usable with
+range-for and standard algorithms. */
+class leaf_range {
+
+public:
+    typedef vector<const tree_node *>::const_iterator const_iterator;
+
+    /* leaf_range(const_iterator b, const_iterator e);
+    Creates a range of the leaves from b up to but not including e.
+        @param      const_iterator b    [in] first leaf in range
+        @param      const_iterator e    [in] one past last leaf in range
+        @pre        b and e are iterators into the same leaf_index.
+        @post       begin() == b and end() == e.
+   */
+    leaf_range(const_iterator b, const_iterator e);
+
+    /* Returns iterator to the leaf with the lowest score */
+    const_iterator begin() const;
+
+    /* Returns iterator past the leaf with the highest score */
+    const_iterator end() const;
+
+    /* Returns number of leaves in range */
+    size_t size() const;
+
+private:
+    const_iterator first;
+    const_iterator last;
+};
+
+/* ostream &operator << (ostream &os, const leaf_range &range);
+Prints the name and score of each leaf in range, e.g. "ape 10, human 12".
+    @param      ostream &os                 [in/out] stream to print to
+    @param      const leaf_range &range     [in] leaves to print
+    @return     ostream &                   [out] os
+    @pre        None.
+    @post       Leaves are written to os in increasing order of score.
+*/
+ostream &operator << (ostream &os, const leaf_range &range);
+
+// Query for the leaves with scores from low to high, inclusive
+struct score_range_query {
+    float low;
+    float high;
+};
+
+// Query for the k leaves with scores closest to score
+struct nearest_query {
+    float score;
+    size_t k;
+};
+
+class leaf_index {
+
+private:
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Copy of the indexed tree. Shares the tree's nodes, which keeps them
+    // alive, and costs O(1).
+    binary_tree tree;
+
+    // Every leaf of the tree, in increasing order of score
+    vector<const tree_node *> sorted_leaves;
+
+    // For every node, the [begin, end) positions of its leaves in sorted_leaves
+    unordered_map<const tree_node *, pair<size_t, size_t> > ranges;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* void range_worker(const vector<score_range_query> &queries, vector<leaf_range> &results, atomic<size_t> &next) const;
+    void nearest_worker(const vector<nearest_query> &queries, vector<leaf_range> &results, atomic<size_t> &next) const;
+    Answer queries, a block at a time, until every block has been taken.
+        @param      queries                 [in] whole batch of queries
+        @param      results                 [in/out] answer to each query
+        @param      atomic<size_t> &next    [in/out] first query not yet taken
+        @pre        Every query has been checked to be valid.
+        @post       The blocks this thread took have been answered.
+   */
+    void range_worker(const vector<score_range_query> &queries, vector<leaf_range> &results, atomic<size_t> &next) const;
+    void nearest_worker(const vector<nearest_query> &queries, vector<leaf_range> &results, atomic<size_t> &next) const;
+
+public:
+
+/******************************************************************************
+     Public Constructor
+******************************************************************************/
+
+    /* leaf_index(const binary_tree &t) throw(invalid_argument, bad_alloc);
+    Sorts the leaves of t by score, then walks t in post-order once, giving each
+    node the span of its children's leaves.
+        @param      const binary_tree &t    [in] tree to index
+        @pre        Each subtree of t covers a contiguous range of scores, as
+                    every tree built from a list of organisms or changed by
+                    add_organism() and remove_organism() does.
+        @post       An index of t that stays valid even if t is later changed
+                    or destroyed. Else throws invalid_argument.
+   */
+    leaf_index(const binary_tree &t) throw(invalid_argument, bad_alloc);
+
+/******************************************************************************
+     Public Accessors
+******************************************************************************/
+
+    /* Returns the number of leaves (organisms) in the tree */
+    size_t size() const;
+
+    /* Returns every leaf of the tree, in increasing order of score */
+    const vector<const tree_node *> &sorted() const;
+
+    /* Returns the tree that was indexed */
+    const binary_tree &indexed_tree() const;
+
+    /* leaf_range leaves_under(const tree_node &node) const throw(invalid_argument);
+    Returns the leaves in the subtree rooted at node, in increasing order of
+    score.
+        @param      const tree_node &node   [in] node of the indexed tree,
+                                            e.g. from one of its traversals
+        @return     leaf_range              [out] node's leaves
+        @pre        node is a node of indexed_tree().
+        @post       Returns in O(1); reading the range costs O(1) per leaf.
+                    Else throws invalid_argument.
+   */
+    leaf_range leaves_under(const tree_node &node) const throw(invalid_argument);
+
+/******************************************************************************
+     Public Score Queries
+******************************************************************************/
+
+    /* leaf_range scores_between(float low, float high) const throw(invalid_argument);
+    Returns the leaves with scores from low to high, inclusive, in increasing
+    order of score.
+        @param      float low       [in] lowest score to include
+        @param      float high      [in] highest score to include
+        @return     leaf_range      [out] leaves in [low, high]; empty if none
+        @pre        low <= high.
+        @post       Returns in O(log n). Else throws invalid_argument.
+   */
+    leaf_range scores_between(float low, float high) const throw(invalid_argument);
+
+    /* leaf_range nearest(float score, size_t k) const throw(invalid_argument);
+    Returns the k leaves with scores closest to score, or every leaf if there
+    are fewer than k. They are always next to each other in score order, and are
+    returned in increasing order of score, not of distance. Of two leaves
+    equally far away, the lower one is closer.
+        @param      float score     [in] score to search around
+        @param      size_t k        [in] number of leaves to return
+        @return     leaf_range      [out] the closest leaves
+        @pre        score is a number.
+        @post       Returns in O(log n + k). Else throws invalid_argument.
+   */
+    leaf_range nearest(float score, size_t k) const throw(invalid_argument);
+
+    /* vector<leaf_range> scores_between(const vector<score_range_query> &queries, size_t threads = 1) const throw(invalid_argument, bad_alloc);
+    vector<leaf_range> nearest(const vector<nearest_query> &queries, size_t threads = 1) const throw(invalid_argument, bad_alloc);
+    Answer a batch of queries, sharing them out between threads.
+        @param      queries             [in] queries to answer
+        @param      size_t threads      [in] number of threads to answer with
+        @return     vector<leaf_range>  [out] answer to each query, in the
+                                        order of queries
+        @pre        threads is positive and every query is valid.
+        @post       Each answer is the same as asking the query on its own.
+                    Else throws invalid_argument, before answering any query.
+   */
+    vector<leaf_range> scores_between(const vector<score_range_query> &queries, size_t threads = 1) const throw(invalid_argument, bad_alloc);
+    vector<leaf_range> nearest(const vector<nearest_query> &queries, size_t threads = 1) const throw(invalid_argument, bad_alloc);
+};
+
+#endif
@@ -10,24 +10,50 @@
  
  Purpose        : To demonstrate an implementation of a binary tree class.
  
- Usage          : ./binary_tree organisms.txt
+ Usage          : ./binary_tree organisms.txt [--stats] [--queue-depth <n>]
+                                [--compact dfs|veb] [--serve <socket>]
+                                [--workers <n>] [--newick] [--threads <n>]
+                                [--output <file>] [--engine reference|sorted]
+                                [--queries <file>]
  (organisms.txt is the file path and name of the songs file and is
- an optional argument. If no argument is given, program will exit with errors.)
+ an optional argument. If no argument is given, program will exit with errors.
+ --stats prints how long each pipeline stage stalled and how full each queue
+ got. --queue-depth sets the number of slots in each pipeline queue.
+ --compact moves the finished tree into one block of memory, in depth first
+ or van Emde Boas order, before it is printed.
+ --serve keeps the tree in memory instead of printing it and answers add,
+ remove, print, related, range, nearest, stats and shutdown commands from
+ clients of a Unix domain socket at the given path. --workers sets how many
+ commands it runs at once. --newick prints the tree in Newick format with
+ branch lengths.
+ --threads writes the tree with n threads at once. --output writes it to a
+ file instead of the console. --engine chooses the algorithm that builds the
+ tree; both build the same tree.
+ --queries answers the score queries in the given file, one per line, either
+ "range <low> <high>" or "nearest <score> <k>", with --threads threads.)
  
- Build with     : g++ -o binary_tree main.cpp binary_tree.cpp tree_node.cpp 
+ Build with     : g++ -std=c++11 -pthread -o binary_tree main.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp pipeline.cpp dendrogram_index.cpp tree_diff.cpp leaf_index.cpp tree_server.cpp tree_serializer.cpp
  
- Last modified  : December 14, 2014
+ Last modified  : October 18, 2026
  
  *******************************************************************************/
 
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
 #include <list>
+#include <sstream>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <new>
 
 #include "binary_tree.h"
+#include "pipeline.h"
+#include "tree_server.h"
+#include "tree_serializer.h"
+#include "leaf_index.h"
 
 using namespace std;
 
@@ -38,12 +64,84 @@ using namespace std;
 
 int main(int argc, const char * argv[]) {
 
-    if (argc == 2) { // Input file given as argument in command line
+    // Optional arguments following the input file
+    bool print_stats = false;
+    long queue_depth = 16;
+    bool compact = false;
+    node_layout layout = DFS_LAYOUT;
+    const char *socket_path = NULL;
+    long workers = 4;
+    bool newick = false;
+    long threads = 0;
+    const char *output_path = NULL;
+    build_engine engine = REFERENCE_ENGINE;
+    const char *query_path = NULL;
+    bool valid_args = (argc >= 2);
+    
+    for (int i = 2; i < argc && valid_args; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            print_stats = true;
+        }
+        else if (strcmp(argv[i], "--queue-depth") == 0 && i + 1 < argc) {
+            queue_depth = atol(argv[++i]);
+            valid_args = (queue_depth > 0);
+        }
+        else if (strcmp(argv[i], "--compact") == 0 && i + 1 < argc) {
+            compact = true;
+            i++;
+            if (strcmp(argv[i], "dfs") == 0) {
+                layout = DFS_LAYOUT;
+            }
+            else if (strcmp(argv[i], "veb") == 0) {
+                layout = VEB_LAYOUT;
+            }
+            else {
+                valid_args = false;
+            }
+        }
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atol(argv[++i]);
+            valid_args = (workers > 0);
+        }
+        else if (strcmp(argv[i], "--newick") == 0) {
+            newick = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atol(argv[++i]);
+            valid_args = (threads > 0);
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "reference") == 0) {
+                engine = REFERENCE_ENGINE;
+            }
+            else if (strcmp(argv[i], "sorted") == 0) {
+                engine = SORTED_ENGINE;
+            }
+            else {
+                valid_args = false;
+            }
+        }
+        else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            query_path = argv[++i];
+        }
+        else {
+            valid_args = false;
+        }
+    }
+
+    if (valid_args) { // Input file given as argument in command line
     
         // Open file from command line argument
         string fName = argv[1];
         ifstream readf;
-        readf.open("organisms.txt");
+        readf.open(fName.c_str());
         
         // If file open fails
         if (readf.fail()){
@@ -51,50 +149,93 @@ int main(int argc, const char * argv[]) {
             exit(-1);
         }
         
-        // A list of binary trees to store all single node trees read from file
-        list<binary_tree> all_single_org_trees;
+        organism_pipeline pipeline(queue_depth);
+        pipeline.build_with(engine);
+        if (compact) {
+            pipeline.compact_with(layout);
+        }
         
-        if (readf.is_open()) {
-            
-            // Reads each line of the file
-            string org_line;
-            while (getline(readf,org_line)) {
+        try {
+            if (query_path != NULL) {
+                // Read every query first, then answer the range and nearest
+                // queries each as one batch shared between threads
+                ifstream queries_file(query_path);
+                if (queries_file.fail()) {
+                    cerr << "ERROR: Invalid query file. Please check your file name and try again." << endl;
+                    exit(-1);
+                }
                 
-                try {
-                    
-                    // Parse line in file and turn into new single node binary tree
-                    binary_tree parse(org_line);
-                    
-                    // Create new copy of tree so won't get re-written when reading
-                    // next line in the file
-                    binary_tree single_organism_tree(parse);
-                    
-                    // Add tree to list of single organism trees
-                    // Will throw bad_alloc if unsuccessful
-                    all_single_org_trees.push_back(single_organism_tree);
+                vector<score_range_query> range_queries;
+                vector<nearest_query> nearest_queries;
+                vector<pair<bool, size_t> > order;     // (is range, position in its batch)
+                string line;
+                for (size_t line_number = 1; getline(queries_file, line); line_number++) {
+                    istringstream words(line);
+                    string kind, extra;
+                    score_range_query range;
+                    nearest_query near;
+                    long k;
                     
+                    if ((words >> kind) && kind == "range" && (words >> range.low >> range.high)
+                        && !(words >> extra) && range.low <= range.high) {
+                        order.push_back(make_pair(true, range_queries.size()));
+                        range_queries.push_back(range);
+                    }
+                    else if (kind == "nearest" && (words >> near.score >> k) && k >= 0 && !(words >> extra)) {
+                        near.k = k;
+                        order.push_back(make_pair(false, nearest_queries.size()));
+                        nearest_queries.push_back(near);
+                    }
+                    else if (!kind.empty()) {
+                        cerr << "ERROR: Skipping invalid query on line " << line_number << ": " << line << endl;
+                    }
                 }
-                catch (bad_alloc& ba) {
-                    // Catch any memory allocation errors and exit
-                    cerr << "ERROR: Failure to allocate memory while reading file" << endl;
-                    exit(-1);
+                queries_file.close();
+                
+                leaf_index index(pipeline.build(readf));
+                size_t query_threads = threads > 0 ? threads : 1;
+                vector<leaf_range> ranges = index.scores_between(range_queries, query_threads);
+                vector<leaf_range> nearest = index.nearest(nearest_queries, query_threads);
+                
+                // Answers in the order the queries were given
+                for (size_t i = 0; i < order.size(); i++) {
+                    const leaf_range &found = order[i].first ? ranges[order[i].second] : nearest[order[i].second];
+                    cout << found.size() << (found.size() == 1 ? " organism" : " organisms");
+                    if (found.size() > 0) {
+                        cout << ": " << found;
+                    }
+                    cout << endl;
                 }
-                catch (invalid_argument& ia){
-                    // Catch any invalid lines from file. Print to error stream and skip over.
-                    cerr << "ERROR: Invalid Organism. " << ia.what() << endl;
+            }
+            else if (socket_path != NULL) {
+                // Build tree once, then keep it in memory and answer commands
+                // until a client asks the server to shut down
+                tree_server server(pipeline.build(readf), workers);
+                readf.close();
+                cerr << "Serving organism tree on " << socket_path << endl;
+                server.serve(socket_path);
+                if (print_stats) {
+                    server.print_stats(cerr);
                 }
             }
-        }
-        
-        // Close file
-        readf.close();
-        
-        try {
-            // Create new binary tree from list of single node organism trees
-            binary_tree organisms_tree(all_single_org_trees);
-            
-            // Output binary tree to console
-            cout << organisms_tree << endl;
+            else if (newick || threads > 0 || output_path != NULL) {
+                // Build tree, then write it with several threads, each one
+                // filling in its own subtrees' place in the output
+                tree_serializer serializer(pipeline.build(readf), newick ? NEWICK_FORMAT : PAREN_FORMAT,
+                                           threads > 0 ? threads : 1);
+                if (output_path != NULL) {
+                    serializer.write_file(output_path);
+                }
+                else {
+                    cout << serializer.str() << endl << endl;
+                }
+            }
+            else {
+                // Read, parse and build tree from file, then output binary
+                // tree to console. Each step runs concurrently with the others.
+                pipeline.run(readf, cout);
+                cout << endl;
+            }
         }
         
         catch (bad_alloc& ba) {
@@ -108,11 +249,34 @@ int main(int argc, const char * argv[]) {
             cerr << "ERROR: Unable to construct tree. " << ia.what() << endl;
             exit(-1);
         }
+        catch (runtime_error &re) {
+            // Catch any failure to set up the server's socket or write the
+            // output file
+            cerr << "ERROR: " << re.what() << endl;
+            exit(-1);
+        }
+        
+        // Close file
+        readf.close();
+        
+        if (print_stats) {
+            pipeline.print_stats(cerr);
+        }
     }
 
-    else { // Invalid number of command line arguments. Exit with errors.
-        cerr << "ERROR: Invalid number of arguments" << endl;
+    else { // Invalid command line arguments. Exit with errors.
+        cerr << "ERROR: Invalid arguments" << endl;
         cerr << "Please run the program by typing into the terminal './binary_tree organisms.txt' where organisms.txt is the name of your input file." << endl;
+        cerr << "Options: --stats               print pipeline stage and queue statistics" << endl;
+        cerr << "         --queue-depth <n>     number of slots in each pipeline queue (default 16)" << endl;
+        cerr << "         --compact dfs|veb     store the finished tree in one block, depth first or van Emde Boas order" << endl;
+        cerr << "         --serve <socket>      keep the tree in memory and answer commands on a Unix domain socket" << endl;
+        cerr << "         --workers <n>         number of commands the server runs at once (default 4)" << endl;
+        cerr << "         --newick              print the tree in Newick format with branch lengths" << endl;
+        cerr << "         --threads <n>         number of threads that write the tree" << endl;
+        cerr << "         --output <file>       write the tree to file instead of the console" << endl;
+        cerr << "         --engine reference|sorted  algorithm to build the tree with (default reference)" << endl;
+        cerr << "         --queries <file>      answer the range and nearest score queries in file" << endl;
 
         exit(-1);
     }
@@ -0,0 +1,288 @@
+/*****************************************************************************
+ Title:             pipeline.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Organism Pipeline Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <thread>
+#include <iomanip>
+
+#include "pipeline.h"
+#include "tree_serializer.h"
+
+/******************************************************************************
+    Constructor
+ ******************************************************************************/
+
+/* Creates a pipeline with the given queue depth, read batch size and output
+chunk size. Nothing is allocated until the pipeline is run. */
+organism_pipeline::organism_pipeline(size_t depth, size_t batch, size_t chunk) throw(invalid_argument)
+    : queue_depth(depth), batch_size(batch), chunk_size(chunk),
+      compact_tree(false), layout(DFS_LAYOUT), engine(REFERENCE_ENGINE), serialize_tree(true),
+      lines_high_water(0), trees_high_water(0), chunks_high_water(0), failed(false) {
+
+    if (depth == 0 || batch == 0 || chunk == 0) {
+        throw invalid_argument("Pipeline queue depth, batch size and chunk size must be positive");
+    }
+}
+
+/******************************************************************************
+    Running the Pipeline
+ ******************************************************************************/
+
+/* Builds the tree and writes it to out */
+void organism_pipeline::run(istream &in, ostream &out) throw(invalid_argument, bad_alloc) {
+    run_stages(in, &out);
+}
+
+/* Builds the tree without serializing it; the build stage closes its output
+queue without pushing anything. */
+binary_tree organism_pipeline::build(istream &in) throw(invalid_argument, bad_alloc) {
+    run_stages(in, NULL);
+    return built_tree;
+}
+
+/* Creates the three queues, runs the read, parse and build stages on their own
+threads and the output stage, if there is a stream to write to, on the
+calling thread. Once every stage has finished, records the queue high water
+marks and rethrows the first error raised by any stage.
+*/
+void organism_pipeline::run_stages(istream &in, ostream *out) throw(invalid_argument, bad_alloc) {
+
+    bounded_queue<vector<string> > lines(queue_depth);
+    bounded_queue<list<binary_tree> > trees(queue_depth);
+    bounded_queue<string> chunks(queue_depth);
+
+    read_stats = parse_stats = build_stats = output_stats = stage_stats();
+    failed = false;
+    error = exception_ptr();
+    serialize_tree = (out != NULL);
+    built_tree = binary_tree();
+
+    thread reader(&organism_pipeline::read_stage, this, ref(in), ref(lines));
+    thread parser(&organism_pipeline::parse_stage, this, ref(lines), ref(trees));
+    thread builder(&organism_pipeline::build_stage, this, ref(trees), ref(chunks));
+
+    if (out != NULL) {
+        output_stage(chunks, *out);
+    }
+
+    reader.join();
+    parser.join();
+    builder.join();
+
+    lines_high_water = lines.high_water_mark();
+    trees_high_water = trees.high_water_mark();
+    chunks_high_water = chunks.high_water_mark();
+
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+/* Chooses the engine that builds the tree in later runs */
+void organism_pipeline::build_with(build_engine e) {
+    engine = e;
+}
+
+/* Turns on compaction of the tree built by later runs */
+void organism_pipeline::compact_with(node_layout l) {
+    compact_tree = true;
+    layout = l;
+}
+
+/* Keeps the first exception thrown by any stage */
+void organism_pipeline::record_error() {
+    lock_guard<mutex> lock(error_mutex);
+    if (!error) {
+        error = current_exception();
+    }
+    failed = true;
+}
+
+/******************************************************************************
+    Stages
+ ******************************************************************************/
+
+/* Reads each line of the input stream into the current batch. Full batches are
+pushed as soon as they are filled so that parsing starts while the rest of the
+file is still being read. The last, partially filled batch is pushed once the
+end of the stream is reached. */
+void organism_pipeline::read_stage(istream &in, bounded_queue<vector<string> > &lines) {
+
+    try {
+        vector<string> batch;
+        batch.reserve(batch_size);
+
+        string org_line;
+        while (!failed && getline(in, org_line)) {
+            batch.push_back(org_line);
+            read_stats.items++;
+
+            if (batch.size() == batch_size) {
+                lines.push(batch, read_stats.output_stall);
+                batch.clear();
+                batch.reserve(batch_size);
+            }
+        }
+
+        if (!batch.empty()) {
+            lines.push(batch, read_stats.output_stall);
+        }
+    }
+    catch (...) {
+        record_error();
+    }
+
+    lines.close();
+}
+
+/* Parses each line of every batch into a new single node binary tree, exactly
+as the single threaded reader did. Trees from a batch are collected in a list
+that the build stage can splice onto its own list without copying. */
+void organism_pipeline::parse_stage(bounded_queue<vector<string> > &lines, bounded_queue<list<binary_tree> > &trees) {
+
+    vector<string> batch;
+    while (lines.pop(batch, parse_stats.input_stall)) {
+
+        // Another stage failed: keep draining so the reader can finish
+        if (failed) {
+            continue;
+        }
+
+        try {
+            list<binary_tree> parsed;
+            for (size_t i = 0; i < batch.size(); i++) {
+                try {
+                    // Parse line in file and turn into new single node binary tree
+                    // Will throw bad_alloc if unsuccessful
+                    parsed.push_back(binary_tree(batch[i]));
+                    parse_stats.items++;
+                }
+                catch (invalid_argument& ia){
+                    // Catch any invalid lines from file. Print to error stream and skip over.
+                    cerr << "ERROR: Invalid Organism. " << ia.what() << endl;
+                }
+            }
+
+            if (!parsed.empty()) {
+                trees.push(parsed, parse_stats.output_stall);
+            }
+        }
+        catch (...) {
+            record_error();
+        }
+    }
+
+    trees.close();
+}
+
+/* Collects every parsed tree in the builder list in input order, then builds
+the hierarchy with the list constructor. The tree is serialized by
+tree_serializer, which produces the same string as print_tree(), and handed to
+the output stage chunk_size bytes at a time.
+*/
+void organism_pipeline::build_stage(bounded_queue<list<binary_tree> > &trees, bounded_queue<string> &chunks) {
+
+    list<binary_tree> all_single_org_trees;
+    list<binary_tree> batch;
+    while (trees.pop(batch, build_stats.input_stall)) {
+        if (!failed) {
+            build_stats.items += batch.size();
+            all_single_org_trees.splice(all_single_org_trees.end(), batch);
+        }
+        batch.clear();
+    }
+
+    // Nothing to build if an earlier stage failed
+    if (failed) {
+        chunks.close();
+        return;
+    }
+
+    try {
+        // Create new binary tree from list of single node organism trees
+        binary_tree organisms_tree(all_single_org_trees, engine);
+        
+        // The list still holds the finished tree; drop it so that compacting
+        // frees the scattered nodes as soon as they have been copied
+        all_single_org_trees.clear();
+        
+        // Move nodes into one block before walking them
+        if (compact_tree) {
+            organisms_tree.compact(layout);
+        }
+
+        // Keep the tree for build(), sharing its nodes
+        built_tree = organisms_tree;
+        if (!serialize_tree) {
+            chunks.close();
+            return;
+        }
+
+        // The serializer measures the tree first, so the whole string is
+        // written into one buffer of the right size
+        string text = tree_serializer(organisms_tree, PAREN_FORMAT).str();
+        text += "\n";
+
+        for (size_t start = 0; start < text.size(); start += chunk_size) {
+            string chunk = text.substr(start, chunk_size);
+            chunks.push(chunk, build_stats.output_stall);
+        }
+    }
+    catch (...) {
+        record_error();
+    }
+
+    chunks.close();
+}
+
+/* Writes chunks to the output stream in the order they were serialized */
+void organism_pipeline::output_stage(bounded_queue<string> &chunks, ostream &out) {
+
+    string chunk;
+    while (chunks.pop(chunk, output_stats.input_stall)) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        out.write(chunk.data(), chunk.size());
+        output_stats.output_stall += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        output_stats.items += chunk.size();
+    }
+    out.flush();
+}
+
+/******************************************************************************
+    Statistics
+ ******************************************************************************/
+
+/* Prints one line per stage, then one line per queue. Stall times are in
+milliseconds. A stage that mostly waits on input is starved by the stage before
+it; a stage that mostly waits on output is held back by the stage after it.
+The output stage's output time is the time spent writing to the stream. */
+void organism_pipeline::print_stats(ostream &os) const {
+
+    const char *names[] = { "read", "parse", "build", "output" };
+    const char *units[] = { "lines", "organisms", "organisms", "bytes" };
+    const stage_stats *stats[] = { &read_stats, &parse_stats, &build_stats, &output_stats };
+
+    os << fixed << setprecision(3);
+    for (int i = 0; i < 4; i++) {
+        os << "stage " << left << setw(7) << names[i] << right
+           << setw(12) << stats[i]->items << " " << left << setw(10) << units[i] << right
+           << " input stall " << setw(10) << stats[i]->input_stall.count() / 1e6 << " ms"
+           << "  output stall " << setw(10) << stats[i]->output_stall.count() / 1e6 << " ms" << endl;
+    }
+
+    const char *queues[] = { "read->parse", "parse->build", "build->output" };
+    size_t high_water[] = { lines_high_water, trees_high_water, chunks_high_water };
+    for (int i = 0; i < 3; i++) {
+        os << "queue " << left << setw(14) << queues[i] << right
+           << " capacity " << setw(6) << queue_depth
+           << "  high water mark " << setw(6) << high_water[i] << endl;
+    }
+    os.unsetf(ios::floatfield);
+    os << setprecision(6);
+}
@@ -0,0 +1,232 @@
+/*****************************************************************************
+ Title:             pipeline.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Organism Pipeline Class Definition (Header File)
+                    - Reads, parses, builds and prints an organism tree in four
+                        concurrent stages connected by bounded queues:
+                        - read:   reads lines of the input stream in batches
+                        - parse:  turns each line into a single node tree,
+                                    reporting and skipping invalid organisms
+                        - build:  inserts parsed trees into the builder list,
+                                    builds the hierarchy, optionally compacts
+                                    it, and serializes it unless the
+                                    tree is only being built
+                        - output: writes serialized chunks to the output stream
+                    - Per-stage item counts and stall times, per-queue
+                        capacities and high water marks for tuning
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __PIPELINE__
+#define __PIPELINE__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+#include "bounded_queue.h"
+
+using namespace std;
+
+class organism_pipeline {
+
+private:
+
+/******************************************************************************
+     Private types
+******************************************************************************/
+
+    // Work and wait times of a single stage
+    struct stage_stats {
+        size_t items;
+        chrono::nanoseconds input_stall;
+        chrono::nanoseconds output_stall;
+        stage_stats() : items(0), input_stall(0), output_stall(0) {}
+    };
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Number of slots in each queue
+    size_t queue_depth;
+
+    // Number of lines read per batch, and bytes of output per chunk
+    size_t batch_size;
+    size_t chunk_size;
+
+    // Whether, and in which order, the build stage compacts the finished tree
+    // before serializing it
+    bool compact_tree;
+    node_layout layout;
+
+    // Algorithm the build stage builds the tree with
+    build_engine engine;
+
+    // Whether the build stage serializes the finished tree, and the tree it
+    // built on the last run
+    bool serialize_tree;
+    binary_tree built_tree;
+
+    // Stage statistics, each written only by its own stage
+    stage_stats read_stats, parse_stats, build_stats, output_stats;
+
+    // Queue high water marks, recorded once a run has finished
+    size_t lines_high_water, trees_high_water, chunks_high_water;
+
+    // Set once any stage fails. The other stages keep draining their input so
+    // that no stage is left blocked on a full queue.
+    atomic<bool> failed;
+    mutex error_mutex;
+    exception_ptr error;
+
+/******************************************************************************
+     Private Stage Functions
+******************************************************************************/
+
+    /* void read_stage(istream &in, bounded_queue<vector<string> > &lines);
+    Reads in line by line and pushes the lines in batches of batch_size.
+        @param      istream &in                         [in/out] organisms
+        @param      bounded_queue<vector<string> > &lines [out] read lines
+        @pre        in is open. Called from its own thread.
+        @post       Every line of in has been pushed and lines is closed.
+   */
+    void read_stage(istream &in, bounded_queue<vector<string> > &lines);
+
+    /* void parse_stage(bounded_queue<vector<string> > &lines, bounded_queue<list<binary_tree> > &trees);
+    Parses each line into a single node organism tree. Invalid organisms are
+    reported to the error stream and skipped over.
+        @param      bounded_queue<vector<string> > &lines   [in] read lines
+        @param      bounded_queue<list<binary_tree> > &trees [out] parsed trees
+        @pre        Called from its own thread.
+        @post       A tree for every valid line has been pushed, in input order,
+                    and trees is closed.
+   */
+    void parse_stage(bounded_queue<vector<string> > &lines, bounded_queue<list<binary_tree> > &trees);
+
+    /* void build_stage(bounded_queue<list<binary_tree> > &trees, bounded_queue<string> &chunks);
+    Splices each batch of parsed trees onto the end of the builder list. Once
+    all trees have arrived, builds the organism hierarchy from the list and
+    pushes its string representation, written by tree_serializer, in chunks of
+    chunk_size bytes.
+        @param      bounded_queue<list<binary_tree> > &trees [in] parsed trees
+        @param      bounded_queue<string> &chunks   [out] serialized tree
+        @pre        Called from its own thread.
+        @post       The whole tree, followed by a newline, has been pushed and
+                    chunks is closed. On failure, the error is recorded.
+   */
+    void build_stage(bounded_queue<list<binary_tree> > &trees, bounded_queue<string> &chunks);
+
+    /* void output_stage(bounded_queue<string> &chunks, ostream &out);
+    Writes each chunk to out as it arrives.
+        @param      bounded_queue<string> &chunks   [in] serialized tree
+        @param      ostream &out                    [in/out] output stream
+        @pre        out is open.
+        @post       Every chunk has been written to out.
+   */
+    void output_stage(bounded_queue<string> &chunks, ostream &out);
+
+    /* void record_error();
+    Records the exception currently being handled as the pipeline's error, if
+    no earlier stage failed first, and tells the other stages to drain.
+        @pre        Called from inside a catch block.
+        @post       failed is true and error holds the first exception thrown.
+   */
+    void record_error();
+
+    /* void run_stages(istream &in, ostream *out) throw(invalid_argument, bad_alloc);
+    Runs the read, parse and build stages on their own threads and, if out is
+    not NULL, the output stage on the calling thread.
+        @param      istream &in     [in/out] open stream of organisms
+        @param      ostream *out    [in/out] stream to write tree to, or NULL
+                                    to build the tree without printing it
+        @pre        in is open; out is NULL or open.
+        @post       built_tree holds the tree and, if out is not NULL, it has
+                    been written to out. Else rethrows the first exception.
+   */
+    void run_stages(istream &in, ostream *out) throw(invalid_argument, bad_alloc);
+
+public:
+
+/******************************************************************************
+     Public Constructor
+******************************************************************************/
+
+    /* organism_pipeline(size_t depth = 16, size_t batch = 256, size_t chunk = 65536) throw(invalid_argument);
+    Creates a pipeline whose queues each hold depth items.
+        @param      size_t depth    [in] number of slots per queue
+        @param      size_t batch    [in] lines per read batch
+        @param      size_t chunk    [in] approximate bytes per output chunk
+        @pre        depth, batch and chunk are positive.
+        @post       A pipeline ready to run. Else throws invalid_argument.
+   */
+    organism_pipeline(size_t depth = 16, size_t batch = 256, size_t chunk = 65536) throw(invalid_argument);
+
+/******************************************************************************
+     Public Functions
+******************************************************************************/
+
+    /* void run(istream &in, ostream &out) throw(invalid_argument, bad_alloc);
+    Reads the organisms in in and writes the string representation of their
+    hierarchy to out, followed by a newline, the same as operator <<.
+        @param      istream &in     [in/out] open stream of organisms, one per
+                                    line
+        @param      ostream &out    [in/out] stream to write tree to
+        @pre        in and out are open.
+        @post       Tree has been written to out and stage statistics are
+                    updated. Else rethrows the first exception thrown by any
+                    stage, e.g. invalid_argument if no organisms were valid.
+   */
+    void run(istream &in, ostream &out) throw(invalid_argument, bad_alloc);
+
+    /* binary_tree build(istream &in) throw(invalid_argument, bad_alloc);
+    Reads the organisms in in and builds their hierarchy, as run() does, but
+    returns the tree instead of printing it.
+        @param      istream &in     [in/out] open stream of organisms, one per
+                                    line
+        @return     binary_tree     [out] hierarchy of the valid organisms
+        @pre        in is open.
+        @post       Stage statistics are updated. Else rethrows the first
+                    exception thrown by any stage.
+   */
+    binary_tree build(istream &in) throw(invalid_argument, bad_alloc);
+
+    /* void build_with(build_engine e);
+    Makes the build stage build the tree with engine e.
+        @param      build_engine e  [in] REFERENCE_ENGINE or SORTED_ENGINE
+        @pre        None.
+        @post       Later runs build their tree with e.
+   */
+    void build_with(build_engine e);
+
+    /* void compact_with(node_layout l);
+    Makes the build stage compact the finished tree into one block of memory,
+    laid out in order l, before serializing it.
+        @param      node_layout l   [in] DFS_LAYOUT or VEB_LAYOUT
+        @pre        None.
+        @post       Later runs compact the tree they build.
+   */
+    void compact_with(node_layout l);
+
+    /* void print_stats(ostream &os) const;
+    Prints the item counts and stall times of each stage and the capacity and
+    high water mark of each queue from the last run.
+        @param      ostream &os     [in/out] stream to write statistics to
+        @pre        run() has been called.
+        @post       Statistics are written to os, one line per stage/queue.
+   */
+    void print_stats(ostream &os) const;
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*****************************************************************************
+ Title:             tree_diff.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Diff Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <algorithm>
+#include <utility>
+
+#include "tree_diff.h"
+
+/******************************************************************************
+    Constructor
+ ******************************************************************************/
+
+/* Keeps the subtrees of each tree not yet matched with the other, starting
+from the two roots. Each new subtree is looked up by hash among the other
+tree's unmatched subtrees, and on a match both are dropped, wherever they sit.
+Otherwise, unmatched internal nodes are split into their children, widest
+score range first: a subtree's ancestors are at least as wide as it is, so the
+other tree has usually opened up everything around an identical subtree by the
+time it is looked up. Splitting stops at the leaves, and what is left of each
+tree is its unmatched organisms.
+    An organism inside a matched subtree has the same sibling in both trees,
+but the subtree as a whole may have been regrouped, e.g. ((e,f),((a,b),(c,d)))
+and ((a,b),((e,f),(c,d))) share every pair. So each matched subtree, and each
+organism left unmatched, is checked for a new sibling cluster, and all its
+organisms are moved if it has one. A subtree that is a whole tree on one side
+has no sibling there; gaining or losing an outgroup doesn't move it. Whether
+the trees are identical, shape included, is just whether their roots' hashes
+are equal.
+*/
+tree_diff::tree_diff(const binary_tree &before, const binary_tree &after) throw(bad_alloc) : compared(0) {
+
+    frontier frontiers[2];
+    split_queue to_split;
+
+    tree_node *roots[2] = { before.get_root_ptr(), after.get_root_ptr() };
+    if (roots[0] == NULL || roots[1] == NULL) {
+        same_root = (roots[0] == roots[1]);
+    }
+    else {
+        same_root = (roots[0]->hash == roots[1]->hash);
+    }
+    for (int side = 0; side < 2; side++) {
+        if (roots[side] != NULL) {
+            frontier_entry root = { roots[side], NULL };
+            enter(side, root, frontiers, to_split);
+        }
+    }
+
+    while (!to_split.empty()) {
+        int side = to_split.top().second.first;
+        unsigned long long hash = to_split.top().second.second;
+        to_split.pop();
+
+        // Matched since it was queued
+        frontier::iterator found = frontiers[side].find(hash);
+        if (found == frontiers[side].end()) {
+            continue;
+        }
+
+        tree_node *split = found->second.node;
+        frontiers[side].erase(found);
+
+        frontier_entry left = { split->left, split->right };
+        frontier_entry right = { split->right, split->left };
+        enter(side, left, frontiers, to_split);
+        enter(side, right, frontiers, to_split);
+    }
+
+    // Only unmatched leaves are left
+    unordered_map<string, leaf_position> old_leaves, new_leaves;
+    unordered_map<string, leaf_position> *leaves[2] = { &old_leaves, &new_leaves };
+    for (int side = 0; side < 2; side++) {
+        for (frontier::iterator it = frontiers[side].begin(); it != frontiers[side].end(); it++) {
+            leaf_position position;
+            position.score = it->second.node->score;
+            position.sibling_cluster = sibling_cluster(it->second.sibling);
+            (*leaves[side])[it->second.node->name] = position;
+        }
+    }
+
+    // Classify organisms left in the old tree
+    unordered_map<string, leaf_position>::iterator it;
+    for (it = old_leaves.begin(); it != old_leaves.end(); it++) {
+        unordered_map<string, leaf_position>::iterator found = new_leaves.find(it->first);
+        if (found == new_leaves.end()) {
+            removed_orgs.push_back(it->first);
+        }
+        else {
+            // 0 stands for no sibling, at a root
+            if (found->second.sibling_cluster != 0 && it->second.sibling_cluster != 0
+                && found->second.sibling_cluster != it->second.sibling_cluster) {
+                moved_orgs.push_back(it->first);
+            }
+            if (found->second.score != it->second.score) {
+                rescored_orgs.push_back(it->first);
+            }
+        }
+    }
+
+    // Organisms left in the new tree only
+    for (it = new_leaves.begin(); it != new_leaves.end(); it++) {
+        if (old_leaves.find(it->first) == old_leaves.end()) {
+            added_orgs.push_back(it->first);
+        }
+    }
+
+    sort(added_orgs.begin(), added_orgs.end());
+    sort(removed_orgs.begin(), removed_orgs.end());
+    sort(moved_orgs.begin(), moved_orgs.end());
+    sort(rescored_orgs.begin(), rescored_orgs.end());
+}
+
+/* Equal hashes mean identical subtrees, so a match needs no further checks */
+void tree_diff::enter(int side, const frontier_entry &entry, frontier *frontiers, split_queue &to_split) {
+
+    compared++;
+    frontier &other = frontiers[1 - side];
+    frontier::iterator match = other.find(entry.node->hash);
+
+    if (match != other.end()) {
+        if (entry.sibling != NULL && match->second.sibling != NULL
+            && entry.sibling->cluster_hash != match->second.sibling->cluster_hash) {
+            move_cluster(entry.node);
+        }
+        other.erase(match);
+        return;
+    }
+
+    frontiers[side][entry.node->hash] = entry;
+    if (entry.node->left != NULL && entry.node->right != NULL) {
+        double width = (double) entry.node->max_score - (double) entry.node->min_score;
+        to_split.push(make_pair(width, make_pair(side, entry.node->hash)));
+    }
+}
+
+unsigned long long tree_diff::sibling_cluster(const tree_node *sibling) {
+    return sibling == NULL ? 0 : sibling->cluster_hash;
+}
+
+/* Collects the subtree's leaves with an explicit stack */
+void tree_diff::move_cluster(const tree_node *tn_ptr) {
+
+    vector<const tree_node *> stack(1, tn_ptr);
+    while (!stack.empty()) {
+        const tree_node *current = stack.back();
+        stack.pop_back();
+        if (current->left == NULL && current->right == NULL) {
+            moved_orgs.push_back(current->name);
+        }
+        else {
+            stack.push_back(current->right);
+            stack.push_back(current->left);
+        }
+    }
+}
+
+/******************************************************************************
+    Accessors
+ ******************************************************************************/
+
+/* Structural hashes cover names, scores and shape */
+bool tree_diff::identical() const {
+    return same_root;
+}
+
+const vector<string> &tree_diff::added() const { return added_orgs; }
+
+const vector<string> &tree_diff::removed() const { return removed_orgs; }
+
+const vector<string> &tree_diff::moved() const { return moved_orgs; }
+
+const vector<string> &tree_diff::rescored() const { return rescored_orgs; }
+
+size_t tree_diff::nodes_compared() const { return compared; }
+
+/******************************************************************************
+    Printing
+ ******************************************************************************/
+
+/* Prints added, removed, moved and rescored organisms in that order */
+ostream &operator << (ostream &os, const tree_diff &diff) {
+
+    for (size_t i = 0; i < diff.added().size(); i++) {
+        os << "+ " << diff.added()[i] << endl;
+    }
+    for (size_t i = 0; i < diff.removed().size(); i++) {
+        os << "- " << diff.removed()[i] << endl;
+    }
+    for (size_t i = 0; i < diff.moved().size(); i++) {
+        os << "~ " << diff.moved()[i] << endl;
+    }
+    for (size_t i = 0; i < diff.rescored().size(); i++) {
+        os << "* " << diff.rescored()[i] << endl;
+    }
+    return os;
+}
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ Title:             tree_diff.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Diff Class Definition (Header File)
+                    - Constructor that compares two organism trees, matching
+                        identical subtrees by structural hash wherever they
+                        sit and skipping them
+                    - Accessors for the organisms added, removed, moved or
+                        rescored between the two trees
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __TREE_DIFF__
+#define __TREE_DIFF__
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+class tree_diff {
+
+private:
+
+/******************************************************************************
+     Private types
+******************************************************************************/
+
+    // A subtree of one tree not yet matched with the other tree, and the
+    // subtree beside it (NULL for a root)
+    struct frontier_entry {
+        tree_node *node;
+        tree_node *sibling;
+    };
+
+    // Unmatched subtrees of one tree, by structural hash. Organism names are
+    // unique, so disjoint subtrees of one tree never share a hash.
+    typedef unordered_map<unsigned long long, frontier_entry> frontier;
+
+    // Unmatched internal nodes waiting to be split: (score range, (tree,
+    // hash)), widest range first
+    typedef priority_queue<pair<double, pair<int, unsigned long long> > > split_queue;
+
+    // Score of an unmatched organism and the cluster hash of its sibling
+    struct leaf_position {
+        float score;
+        unsigned long long sibling_cluster;
+    };
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Organisms only in the new tree, only in the old tree, in both trees
+    // but at a different position, and in both trees with a different score.
+    // Each list is sorted by name.
+    vector<string> added_orgs;
+    vector<string> removed_orgs;
+    vector<string> moved_orgs;
+    vector<string> rescored_orgs;
+
+    // Number of subtrees looked up in the other tree
+    size_t compared;
+
+    // Whether the two roots have the same structural hash
+    bool same_root;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* void enter(int side, const frontier_entry &entry, frontier *frontiers, split_queue &to_split);
+    Looks up a subtree of one tree among the unmatched subtrees of the other.
+    If an identical one is there, the two are matched and neither is visited
+    again; otherwise the subtree joins its own tree's unmatched subtrees.
+        @param      int side                    [in] 0 for before, 1 for after
+        @param      const frontier_entry &entry [in] subtree and its sibling
+        @param      frontier *frontiers         [in/out] unmatched subtrees of
+                                                before and after
+        @param      split_queue &to_split       [in/out] internal nodes to split
+        @pre        entry.node is not NULL.
+        @post       If the matched subtree has a sibling in both trees and
+                    their clusters differ, every organism in it is moved.
+                    compared is incremented.
+   */
+    void enter(int side, const frontier_entry &entry, frontier *frontiers, split_queue &to_split);
+
+    /* static unsigned long long sibling_cluster(const tree_node *sibling);
+    Returns the cluster hash of the subtree beside an organism.
+        @param      const tree_node *sibling    [in] sibling, or NULL at a root
+        @return     unsigned long long          [out] its cluster hash, or 0
+        @pre        None.
+        @post       None.
+   */
+    static unsigned long long sibling_cluster(const tree_node *sibling);
+
+    /* void move_cluster(const tree_node *tn_ptr);
+    Marks every organism in the subtree rooted at tn_ptr as moved.
+        @param      const tree_node *tn_ptr     [in] root of matched subtree
+        @pre        tn_ptr is not NULL.
+        @post       Names of the subtree's leaves are added to moved_orgs.
+                    Takes time proportional to the size of the subtree.
+   */
+    void move_cluster(const tree_node *tn_ptr);
+
+public:
+
+/******************************************************************************
+     Public Constructor
+******************************************************************************/
+
+    /* tree_diff(const binary_tree &before, const binary_tree &after) throw(bad_alloc);
+    Compares the two trees from their roots down. A subtree of one tree with
+    the same hash as a subtree anywhere in the other is identical to it and is
+    skipped without being visited, even if it now sits elsewhere, unless it
+    was joined to a different cluster, in which case its organisms are moved.
+    The organisms left over are compared by name, score and sibling cluster.
+        @param      const binary_tree &before   [in] earlier tree
+        @param      const binary_tree &after    [in] later tree
+        @pre        Organism names are unique within each tree.
+        @post       added(), removed(), moved() and rescored() describe how to
+                    get from before to after. Work done is proportional to the
+                    number of nodes outside the matched subtrees, not to the
+                    size of the trees.
+   */
+    tree_diff(const binary_tree &before, const binary_tree &after) throw(bad_alloc);
+
+/******************************************************************************
+     Public Accessors
+******************************************************************************/
+
+    /* Returns true if the two trees have the same organisms, scores and shape,
+    i.e. their roots have the same structural hash */
+    bool identical() const;
+
+    /* Returns names of organisms in after but not in before */
+    const vector<string> &added() const;
+
+    /* Returns names of organisms in before but not in after */
+    const vector<string> &removed() const;
+
+    /* Returns names of organisms in both trees that were joined to a different
+    group of organisms: either their own sibling cluster (the set of organisms
+    in the subtree beside them) differs, or they lie in a subtree found
+    unchanged in both trees whose sibling cluster differs */
+    const vector<string> &moved() const;
+
+    /* Returns names of organisms in both trees whose score differs */
+    const vector<string> &rescored() const;
+
+    /* Returns the number of subtrees looked up in the other tree, a measure of
+    the work done */
+    size_t nodes_compared() const;
+};
+
+/* ostream &operator << (ostream &os, const tree_diff &diff);
+Prints one line per changed organism: "+ name" if added, "- name" if removed,
+"~ name" if moved and "* name" if rescored.
+    @param      ostream &os             [in/out] stream to write out to
+    @param      const tree_diff &diff   [in] diff to print
+    @return     ostream &os             [in/out] stream to write out to
+    @pre        os is open.
+    @post       Nothing is printed if the trees are identical.
+ */
+ostream &operator << (ostream &os, const tree_diff &diff);
+
+#endif
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ Title:             tree_iterator.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Iterator and Tree Range Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include "tree_iterator.h"
+
+/******************************************************************************
+    Constructors
+ ******************************************************************************/
+
+/* Creates an end iterator */
+tree_iterator::tree_iterator() : order(PRE_ORDER), current(NULL) {}
+
+/* Sets up the stack for the chosen order, then advances to the first node:
+pre-order, post-order and leaf order start from the root, in-order starts from
+the leftmost node. */
+tree_iterator::tree_iterator(const tree_node *root, traversal_order o) : order(o), current(NULL) {
+
+    if (root == NULL) {
+        return;
+    }
+
+    if (order == IN_ORDER) {
+        push_left_path(root);
+    }
+    else {
+        stack.push_back(make_pair(root, false));
+    }
+    advance();
+}
+
+/******************************************************************************
+    Moving Through the Tree
+ ******************************************************************************/
+
+/* Pushes the path of left children starting at tn_ptr */
+void tree_iterator::push_left_path(const tree_node *tn_ptr) {
+    while (tn_ptr != NULL) {
+        stack.push_back(make_pair(tn_ptr, false));
+        tn_ptr = tn_ptr->get_left();
+    }
+}
+
+/* Pre-order and leaf order pop the next node and push its right child then
+its left child, so the left subtree is visited first; leaf order skips over
+internal nodes. In-order pops the next node and pushes the left path of its
+right subtree. Post-order looks at the top of the stack: a leaf, or a node
+whose children were already pushed and have now been visited, is next;
+otherwise its children are pushed and it waits underneath them.
+*/
+void tree_iterator::advance() {
+
+    current = NULL;
+
+    while (!stack.empty()) {
+        const tree_node *tn_ptr = stack.back().first;
+
+        if (order == IN_ORDER) {
+            stack.pop_back();
+            push_left_path(tn_ptr->get_right());
+            current = tn_ptr;
+            return;
+        }
+
+        if (order == POST_ORDER) {
+            if (tn_ptr->is_leaf() || stack.back().second) {
+                stack.pop_back();
+                current = tn_ptr;
+                return;
+            }
+            stack.back().second = true;
+        }
+        else {
+            stack.pop_back();
+        }
+
+        if (tn_ptr->get_right() != NULL) {
+            stack.push_back(make_pair(tn_ptr->get_right(), false));
+        }
+        if (tn_ptr->get_left() != NULL) {
+            stack.push_back(make_pair(tn_ptr->get_left(), false));
+        }
+
+        if (order == PRE_ORDER || (order == LEAF_ORDER && tn_ptr->is_leaf())) {
+            current = tn_ptr;
+            return;
+        }
+    }
+}
+
+/******************************************************************************
+    Operators
+ ******************************************************************************/
+
+tree_iterator::reference tree_iterator::operator * () const { return *current; }
+
+tree_iterator::pointer tree_iterator::operator -> () const { return current; }
+
+tree_iterator &tree_iterator::operator ++ () {
+    advance();
+    return *this;
+}
+
+tree_iterator tree_iterator::operator ++ (int) {
+    tree_iterator before(*this);
+    advance();
+    return before;
+}
+
+bool tree_iterator::operator == (const tree_iterator &other) const { return current == other.current; }
+
+bool tree_iterator::operator != (const tree_iterator &other) const { return current != other.current; }
+
+/******************************************************************************
+    Tree Range
+ ******************************************************************************/
+
+tree_range::tree_range(const tree_node *r, traversal_order o) : root(r), order(o) {}
+
+tree_iterator tree_range::begin() const { return tree_iterator(root, order); }
+
+tree_iterator tree_range::end() const { return tree_iterator(); }
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ Title:             tree_iterator.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Iterator and Tree Range Class Definitions (Header
+                    File)
+                    - Forward iterator over the nodes of a tree in pre-order,
+                        in-order, post-order, or over its leaves only
+                    - Keeps its place on a small explicit stack, a few entries
+                        per level of the tree, instead of recursing
+                    - Tree range with begin() and end() so that a traversal
+                        can be used with range-for and standard algorithms
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __TREE_ITERATOR__
+#define __TREE_ITERATOR__
+
+#include <iterator>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+#include "tree_node.h"
+
+using namespace std;
+
+/* Order in which a tree_iterator visits the nodes of a tree */
+enum traversal_order {
+    PRE_ORDER,      // node, then left subtree, then right subtree
+    IN_ORDER,       // left subtree, then node, then right subtree
+    POST_ORDER,     // left subtree, then right subtree, then node
+    LEAF_ORDER      // leaves only, left to right, as printed by operator <<
+};
+
+class tree_iterator {
+
+private:
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    traversal_order order;
+
+    // Node the iterator points to, NULL once past the last node
+    const tree_node *current;
+
+    // Nodes still to be visited, or to be returned to, with a flag recording
+    // whether their children have already been pushed (post-order only)
+    vector<pair<const tree_node *, bool> > stack;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* void push_left_path(const tree_node *tn_ptr);
+    Pushes tn_ptr and every node on the path of left children below it.
+        @param      const tree_node *tn_ptr     [in] top of path, or NULL
+        @pre        order is IN_ORDER.
+        @post       Leftmost node below tn_ptr is on top of the stack.
+   */
+    void push_left_path(const tree_node *tn_ptr);
+
+    /* void advance();
+    Moves current to the next node in order.
+        @pre        None.
+        @post       current is the next node, or NULL if there are no more.
+   */
+    void advance();
+
+public:
+
+/******************************************************************************
+     Iterator Traits
+******************************************************************************/
+
+    typedef forward_iterator_tag iterator_category;
+    typedef tree_node value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const tree_node *pointer;
+    typedef const tree_node &reference;
+
+/******************************************************************************
+     Public Constructors
+******************************************************************************/
+
+    /* tree_iterator();
+    Creates an iterator that points past the last node of any tree.
+        @pre        None.
+        @post       Iterator is equal to the end of every traversal.
+   */
+    tree_iterator();
+
+    /* tree_iterator(const tree_node *root, traversal_order o);
+    Creates an iterator that points to the first node of the tree rooted at
+    root in order o.
+        @param      const tree_node *root   [in] root of tree, or NULL
+        @param      traversal_order o       [in] order to visit nodes in
+        @pre        root is NULL or the root of an initialized tree.
+        @post       Iterator points to the first node in order, or equals the
+                    end iterator if root is NULL.
+   */
+    tree_iterator(const tree_node *root, traversal_order o);
+
+/******************************************************************************
+     Iterator Operators
+******************************************************************************/
+
+    /* Returns the node the iterator points to */
+    reference operator * () const;
+    pointer operator -> () const;
+
+    /* Moves to the next node, returning the iterator after (prefix) or before
+    (postfix) the move */
+    tree_iterator &operator ++ ();
+    tree_iterator operator ++ (int);
+
+    /* Two iterators are equal if they point to the same node, or are both past
+    the end */
+    bool operator == (const tree_iterator &other) const;
+    bool operator != (const tree_iterator &other) const;
+};
+
+/* A traversal of a tree that can be used with range-for, e.g.
+    for (const tree_node &leaf : tree.leaves()) ...
+Like iterators into a standard container, a range is only valid while the tree
+it came from still exists and has not been changed. */
+class tree_range {
+
+private:
+    const tree_node *root;
+    traversal_order order;
+
+public:
+
+    /* tree_range(const tree_node *r, traversal_order o);
+    Creates a traversal in order o of the tree rooted at r.
+        @param      const tree_node *r      [in] root of tree, or NULL
+        @param      traversal_order o       [in] order to visit nodes in
+        @pre        r is NULL or the root of an initialized tree.
+        @post       begin() and end() span every node visited by o.
+   */
+    tree_range(const tree_node *r, traversal_order o);
+
+    /* Returns an iterator to the first node in order */
+    tree_iterator begin() const;
+
+    /* Returns an iterator past the last node */
+    tree_iterator end() const;
+};
+
+#endif
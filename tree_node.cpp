@@ -4,25 +4,97 @@
  Created on:        December 6, 2014
  Description:       Tree Node Implementation
  
- Last Modified:     December 14, 2014
+ Last Modified:     October 18, 2026
  
  *****************************************************************************/
 
+#include <cstring>
+#include <algorithm>
+
 #include "tree_node.h"
 
 /* Creates an empty tree node with NULL left and right pointers*/
-tree_node::tree_node(){
+tree_node::tree_node() : ref_count(1), block(NULL) {
+    height = 0;
+    hash = 0;
+    cluster_hash = 0;
+    min_score = max_score = 0;
     left = NULL;
     right = NULL;
 };
 
 /* Creates a tree node containing containing the name and score for a single
 organism and optional pointers to left and right subtrees */
-tree_node::tree_node(const string &n, const float &s, tree_node *left_tree, tree_node *right_tree):name(n), score(s), left(left_tree), right(right_tree){
+tree_node::tree_node(const string &n, const float &s, tree_node *left_tree, tree_node *right_tree):name(n), score(s), height(0), ref_count(1), block(NULL), left(left_tree), right(right_tree){
+    if (left != NULL && right != NULL) {
+        hash = merge_hash(left->hash, right->hash);
+        cluster_hash = left->cluster_hash + right->cluster_hash;
+        min_score = min(left->min_score, right->min_score);
+        max_score = max(left->max_score, right->max_score);
+    }
+    else {
+        hash = leaf_hash(n, s);
+        cluster_hash = name_hash(n);
+        min_score = max_score = s;
+    }
 };
 
-/* Properly destroys a tree node */
+/* Properly destroys a tree node. Its children may still be in use by other
+trees, so releasing them is up to binary_tree. */
 tree_node::~tree_node() {
-    delete left;
-    delete right;
-};
\ No newline at end of file
+    left = NULL;
+    right = NULL;
+};
+
+/* Read-only accessors */
+const string &tree_node::get_name() const { return name; }
+
+float tree_node::get_score() const { return score; }
+
+float tree_node::get_height() const { return height; }
+
+bool tree_node::is_leaf() const { return left == NULL && right == NULL; }
+
+const tree_node *tree_node::get_left() const { return left; }
+
+const tree_node *tree_node::get_right() const { return right; }
+
+/* Mixes the bits of x so that nearby inputs give unrelated outputs
+(the finalizer of the SplitMix64 generator) */
+static unsigned long long mix(unsigned long long x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/* Hashes the organism's name with FNV-1a */
+static unsigned long long fnv_hash(const string &n) {
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < n.size(); i++) {
+        h ^= (unsigned char) n[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* Folds the bit pattern of the organism's score into the hash of its name */
+unsigned long long tree_node::leaf_hash(const string &n, const float &s) {
+    unsigned long long h = fnv_hash(n);
+    
+    unsigned int score_bits = 0;
+    memcpy(&score_bits, &s, sizeof(score_bits));
+    return mix(h ^ mix(score_bits));
+}
+
+/* Mixed, so that sums of name hashes are spread over all 64 bits */
+unsigned long long tree_node::name_hash(const string &n) {
+    return mix(fnv_hash(n) + 1);
+}
+
+/* Combines the children's hashes asymmetrically so (a,b) and (b,a) differ */
+unsigned long long tree_node::merge_hash(unsigned long long left_hash, unsigned long long right_hash) {
+    return mix(mix(left_hash) + 0x9e3779b97f4a7c15ULL * right_hash + 1);
+}
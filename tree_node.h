@@ -7,9 +7,16 @@
                     - Constructor for tree node with organism data for single
                     organism
                     - Destructor
-                    - Friend Class: Binary Tree
+                    - Structural hashes of leaf and internal nodes
+                    - Reference count shared by every tree using the node
+                    - Node block holding every node of a compacted tree
+                    - Node of the name index that finds an organism's score
+                        by name
+                    - Public read-only accessors
+                    - Friend Classes: Binary Tree, Organism Pipeline,
+                    Dendrogram Index, Tree Diff
  
- Last Modified:     December 14, 2014
+ Last Modified:     October 18, 2026
  
  *****************************************************************************/
 
@@ -19,9 +26,36 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <utility>
+#include <atomic>
 
 using namespace std;
 
+class tree_node;
+
+/* A single allocation holding every node of a compacted tree, laid out in the
+order chosen by binary_tree::compact(). Nodes inside a block point only to
+other nodes of the same block and share the block's reference count, so the
+whole block is freed at once when no tree or outside node points into it. */
+struct node_block {
+    atomic<int> ref_count;
+    size_t count;
+    tree_node *nodes;
+};
+
+/* One node of the index binary_tree keeps from organism names to scores. The
+index is a trie on the name hash, 4 bits per level: a node either branches on
+the next 4 bits into 16 children, or holds the organisms whose names share one
+hash. Like tree nodes, index nodes are never changed once shared, so copies of
+a tree share the index and a change copies only the nodes on one branch. */
+struct name_node {
+    atomic<int> ref_count;
+    unsigned long long hash;                // name hash of entries, if any
+    vector<pair<string, float> > entries;   // (name, score); empty if branch
+    name_node *children[16];                // all NULL unless a branch
+};
+
 class tree_node {
     
 private:
@@ -34,6 +68,30 @@ private:
     string name;
     float score;
     
+    // Score gap between the two trees merged to form this node (0 for leaves)
+    float height;
+    
+    // Structural hash of the subtree rooted at this node. Two subtrees with
+    // the same hash have the same organisms, scores and shape.
+    unsigned long long hash;
+    
+    // Hash of the set of organism names in the subtree rooted at this node,
+    // whatever its shape or scores: the sum of a hash of each name. Two
+    // subtrees with the same cluster hash hold the same organisms.
+    unsigned long long cluster_hash;
+    
+    // Smallest and largest organism score in the subtree rooted at this node
+    float min_score;
+    float max_score;
+    
+    // Number of trees and parent nodes pointing to this node. Nodes are never
+    // changed once they are shared, so copies of a tree share all of them.
+    atomic<int> ref_count;
+    
+    // Block this node was compacted into, or NULL if allocated on its own.
+    // Nodes in a block are counted by the block's ref_count instead.
+    node_block *block;
+    
     // Pointers to left and right children of node (if any)
     tree_node *left;
     tree_node *right;
@@ -45,8 +103,10 @@ private:
     /* tree_node();
     Creates a new, empty tree_node whose left = NULL and right = NULL.
         @pre        None.
-        @post       A new tree_node whose left and right pointers = NULL and 
-                    whose name and score member variables are empty.
+        @post       A new tree_node whose left and right pointers = NULL, 
+                    whose name and score member variables are empty, whose
+                    height, hashes and score range are 0, whose reference
+                    count is 1 and whose block is NULL.
    */
     tree_node();
     
@@ -62,19 +122,92 @@ private:
         @pre        &n and &s are non-empty and initialized. left_tree and
                     right_tree are either NULL or non-empty tree_nodes.
         @post       A new tree_node whose name and score variables are n and s
-                    respectively and whose left and right pointers point to
-                    left_tree and right_tree respectively. 
+                    respectively, whose height is 0 and whose left and right
+                    pointers point to left_tree and right_tree respectively. 
+                    hash is the merge hash of the two subtrees if both are
+                    given, else the leaf hash of n and s. cluster_hash is
+                    the sum of the subtrees' if given, else the name hash of
+                    n. min_score and
+                    max_score span the scores of the subtrees if given, else
+                    are s. Reference count is 1 and block is NULL; the
+                    reference counts of left_tree and right_tree are unchanged.
    */
     tree_node(const string &n, const float &s, tree_node *left_tree = NULL, tree_node *right_tree = NULL);
     
     /* ~tree_node();
-    Destroys tree_node data and deallocates any memory.
-        @pre        tree_node is an intialized, non-empty tree_node
+    Destroys tree_node data and deallocates any memory. Children are left
+    alone: they may be shared, and binary_tree releases them itself.
+        @pre        tree_node is an intialized, non-empty tree_node whose
+                    reference count has dropped to 0
         @post       Tree_node data is purged, memory used to store tree_node is
                     deallocated to ensure no memory leaks or dangling pointers.
     */
     ~tree_node();
     
+/******************************************************************************
+     Private Hash Functions
+******************************************************************************/
+    
+    /* static unsigned long long leaf_hash(const string &n, const float &s);
+    Returns the hash of a single organism leaf.
+        @param      const string &n     [in] name of organism
+        @param      const float &s      [in] organism's genome score
+        @return     unsigned long long  [out] hash of name and score
+        @pre        None.
+        @post       Equal names and scores always give equal hashes.
+   */
+    static unsigned long long leaf_hash(const string &n, const float &s);
+    
+    /* static unsigned long long name_hash(const string &n);
+    Returns the hash of an organism's name alone, which a leaf contributes to
+    the cluster hash of every subtree holding it.
+        @param      const string &n     [in] name of organism
+        @return     unsigned long long  [out] hash of name
+        @pre        None.
+        @post       Equal names always give equal hashes.
+   */
+    static unsigned long long name_hash(const string &n);
+    
+    /* static unsigned long long merge_hash(unsigned long long left_hash, unsigned long long right_hash);
+    Returns the hash of an internal node from the hashes of its children.
+        @param      unsigned long long left_hash    [in] hash of left subtree
+        @param      unsigned long long right_hash   [in] hash of right subtree
+        @return     unsigned long long  [out] hash of the combined subtree
+        @pre        None.
+        @post       Order matters: swapping the subtrees changes the hash.
+   */
+    static unsigned long long merge_hash(unsigned long long left_hash, unsigned long long right_hash);
+    
+    
+public:
+    
+/******************************************************************************
+     Public Accessors
+******************************************************************************/
+    
+    /* Nodes are read-only outside binary_tree. These let code walking a tree
+     with a tree_iterator read each node's data. */
+    
+    /* Returns name of organism, or combined name of an internal node */
+    const string &get_name() const;
+    
+    /* Returns genome score of organism, or average score of an internal node */
+    float get_score() const;
+    
+    /* Returns score gap the node's two subtrees were merged at (0 for leaves) */
+    float get_height() const;
+    
+    /* Returns true if node has no children, i.e. holds a single organism */
+    bool is_leaf() const;
+    
+    /* Returns left child of node, or NULL for a leaf */
+    const tree_node *get_left() const;
+    
+    /* Returns right child of node, or NULL for a leaf */
+    const tree_node *get_right() const;
+    
+    
+private:
     
 /******************************************************************************
      Friend classes and functions
@@ -88,6 +221,27 @@ private:
      */
     
     friend class binary_tree;
+    
+    /* friend class organism_pipeline;
+     Allows the organism pipeline to walk a finished tree and serialize it in
+     chunks while earlier chunks are being written out.
+     */
+    
+    friend class organism_pipeline;
+    
+    /* friend class dendrogram_index;
+     Allows the dendrogram index to read node heights and walk a finished tree
+     once to precompute its cluster cuts.
+     */
+    
+    friend class dendrogram_index;
+    
+    /* friend class tree_diff;
+     Allows a tree diff to compare subtree hashes and skip identical subtrees,
+     and to compare the clusters beside an organism in two trees.
+     */
+    
+    friend class tree_diff;
 };
 
 #endif
\ No newline at end of file
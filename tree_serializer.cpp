@@ -0,0 +1,336 @@
+/*****************************************************************************
+ Title:             tree_serializer.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Serializer Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "tree_serializer.h"
+
+// Smallest number of nodes worth handing to a thread on its own
+static const size_t MIN_GRAIN = 1024;
+
+/******************************************************************************
+    Constructor
+ ******************************************************************************/
+
+/* Lays the nodes out in pre-order with a stack, then counts the nodes under
+each one from the back, where both children of a node have already been
+counted. Cuts the tree below every node holding more than grain nodes, by
+default about an eighth of each thread's share; the subtrees below the cut are
+measured in parallel, then the nodes above it, children before parents, and
+finally each node above the cut hands out the start of its children's output:
+just after its "(", and just after the "," that follows its left child. */
+tree_serializer::tree_serializer(const binary_tree &t, tree_format f, size_t threads,
+                                 const tree_node *subtree, size_t grain) throw(invalid_argument, bad_alloc)
+    : tree(t), format(f), thread_count(threads), total_bytes(0) {
+
+    if (threads == 0) {
+        throw invalid_argument("Serializer needs at least one thread");
+    }
+    if (subtree == NULL) {
+        subtree = tree.get_root_ptr();
+    }
+    if (subtree == NULL) {
+        throw invalid_argument("Tree is empty");
+    }
+
+    // Pre-order layout. Each stack entry carries its parent's score.
+    vector<pair<const tree_node *, float> > stack;
+    stack.push_back(make_pair(subtree, subtree->get_score()));
+    while (!stack.empty()) {
+        const tree_node *tn_ptr = stack.back().first;
+        float parent_score = stack.back().second;
+        stack.pop_back();
+
+        nodes.push_back(tn_ptr);
+        if (format == NEWICK_FORMAT) {
+            branch_lengths.push_back(fabs(parent_score - tn_ptr->get_score()));
+        }
+        if (!tn_ptr->is_leaf()) {
+            stack.push_back(make_pair(tn_ptr->get_right(), tn_ptr->get_score()));
+            stack.push_back(make_pair(tn_ptr->get_left(), tn_ptr->get_score()));
+        }
+    }
+
+    size_t n = nodes.size();
+    subtree_nodes.resize(n);
+    subtree_bytes.resize(n);
+    for (size_t i = n; i-- > 0; ) {
+        if (nodes[i]->is_leaf()) {
+            subtree_nodes[i] = 1;
+        }
+        else {
+            subtree_nodes[i] = 1 + subtree_nodes[i + 1] + subtree_nodes[i + 1 + subtree_nodes[i + 1]];
+        }
+    }
+
+    // Cut the tree into tasks of at most grain nodes
+    if (grain == 0) {
+        grain = max(MIN_GRAIN, n / (thread_count * 8));
+    }
+    vector<size_t> cut_stack(1, 0);
+    while (!cut_stack.empty()) {
+        size_t i = cut_stack.back();
+        cut_stack.pop_back();
+
+        if (subtree_nodes[i] > grain && !nodes[i]->is_leaf()) {
+            glue.push_back(i);
+            cut_stack.push_back(i + 1 + subtree_nodes[i + 1]);
+            cut_stack.push_back(i + 1);
+        }
+        else {
+            tasks.push_back(i);
+        }
+    }
+
+    run_tasks(&tree_serializer::measure_task_at, NULL);
+
+    for (size_t g = glue.size(); g-- > 0; ) {
+        size_t i = glue[g];
+        size_t left = i + 1, right = i + 1 + subtree_nodes[i + 1];
+        subtree_bytes[i] = 3 + subtree_bytes[left] + subtree_bytes[right] + branch_bytes(i);
+    }
+
+    offsets[0] = 0;
+    for (size_t g = 0; g < glue.size(); g++) {
+        size_t i = glue[g];
+        size_t left = i + 1, right = i + 1 + subtree_nodes[i + 1];
+        offsets[left] = offsets[i] + 1;
+        offsets[right] = offsets[i] + 2 + subtree_bytes[left];
+    }
+
+    total_bytes = subtree_bytes[0] + (format == NEWICK_FORMAT ? 1 : 0);
+}
+
+/******************************************************************************
+    Measuring
+ ******************************************************************************/
+
+/* The root has no branch; every other node prints ":" and its length in
+Newick format. */
+size_t tree_serializer::branch_bytes(size_t i) const {
+    if (format != NEWICK_FORMAT || i == 0) {
+        return 0;
+    }
+    char length[32];
+    return 1 + format_length(branch_lengths[i], length);
+}
+
+/* "%g" prints up to 6 significant digits without trailing zeros, as an
+ostream does at its default precision */
+int tree_serializer::format_length(float length, char *out) {
+    return snprintf(out, 32, "%g", (double) length);
+}
+
+/* Newick quotes a name in single quotes and doubles any single quote inside
+it */
+size_t tree_serializer::name_bytes(size_t i) const {
+    const string &name = nodes[i]->get_name();
+    if (format != NEWICK_FORMAT || !needs_quotes(name)) {
+        return name.size();
+    }
+    return name.size() + 2 + count(name.begin(), name.end(), '\'');
+}
+
+bool tree_serializer::needs_quotes(const string &name) {
+    return name.find_first_of(" \t()[]':;,_") != string::npos;
+}
+
+/* A task's nodes are contiguous in pre-order, so walking them from the back
+reaches both children of a node before the node itself */
+void tree_serializer::measure_task(size_t task) {
+
+    size_t first = tasks[task];
+    for (size_t i = first + subtree_nodes[first]; i-- > first; ) {
+        if (nodes[i]->is_leaf()) {
+            subtree_bytes[i] = name_bytes(i) + branch_bytes(i);
+        }
+        else {
+            size_t left = i + 1, right = i + 1 + subtree_nodes[i + 1];
+            subtree_bytes[i] = 3 + subtree_bytes[left] + subtree_bytes[right] + branch_bytes(i);
+        }
+    }
+}
+
+/******************************************************************************
+    Writing
+ ******************************************************************************/
+
+size_t tree_serializer::write_name(size_t i, char *out) const {
+    const string &name = nodes[i]->get_name();
+    if (format != NEWICK_FORMAT || !needs_quotes(name)) {
+        memcpy(out, name.data(), name.size());
+        return name.size();
+    }
+
+    size_t pos = 0;
+    out[pos++] = '\'';
+    for (size_t c = 0; c < name.size(); c++) {
+        if (name[c] == '\'') {
+            out[pos++] = '\'';
+        }
+        out[pos++] = name[c];
+    }
+    out[pos++] = '\'';
+    return pos;
+}
+
+size_t tree_serializer::write_branch(size_t i, char *out) const {
+    if (format != NEWICK_FORMAT || i == 0) {
+        return 0;
+    }
+    char length[32];
+    int count = format_length(branch_lengths[i], length);
+    out[0] = ':';
+    memcpy(out + 1, length, count);
+    return 1 + count;
+}
+
+/* Walks the subtree with an explicit stack of (node, visits), writing "("
+before, "," between and ")" after the subtrees of each internal node. */
+void tree_serializer::write_subtree(size_t i, char *out) const {
+
+    vector<pair<size_t, int> > stack;
+    stack.push_back(make_pair(i, 0));
+    size_t pos = 0;
+
+    while (!stack.empty()) {
+        size_t current = stack.back().first;
+        int visits = stack.back().second;
+        stack.pop_back();
+
+        if (nodes[current]->is_leaf()) {
+            pos += write_name(current, out + pos);
+            pos += write_branch(current, out + pos);
+        }
+        else if (visits == 0) {
+            out[pos++] = '(';
+            stack.push_back(make_pair(current, 1));
+            stack.push_back(make_pair(current + 1, 0));
+        }
+        else if (visits == 1) {
+            out[pos++] = ',';
+            stack.push_back(make_pair(current, 2));
+            stack.push_back(make_pair(current + 1 + subtree_nodes[current + 1], 0));
+        }
+        else {
+            out[pos++] = ')';
+            pos += write_branch(current, out + pos);
+        }
+    }
+}
+
+/* The nodes above the cut write their own punctuation and branch lengths
+around the space left for their children; the tasks fill in that space in
+parallel. */
+void tree_serializer::write(char *out) {
+
+    for (size_t g = 0; g < glue.size(); g++) {
+        size_t i = glue[g];
+        size_t left = i + 1, right = i + 1 + subtree_nodes[i + 1];
+        char *start = out + offsets[i];
+
+        start[0] = '(';
+        start[1 + subtree_bytes[left]] = ',';
+        start[2 + subtree_bytes[left] + subtree_bytes[right]] = ')';
+        write_branch(i, start + 3 + subtree_bytes[left] + subtree_bytes[right]);
+    }
+
+    run_tasks(&tree_serializer::write_task_at, out);
+
+    if (format == NEWICK_FORMAT) {
+        out[total_bytes - 1] = ';';
+    }
+}
+
+string tree_serializer::str() {
+    string out(total_bytes, '\0');
+    write(&out[0]);
+    return out;
+}
+
+/* Sizes the file first so that mapping it gives every thread somewhere to
+write, then unmaps it, which leaves the kernel to write the pages out. */
+void tree_serializer::write_file(const string &path) throw(runtime_error) {
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw runtime_error("Unable to open '" + path + "': " + strerror(errno));
+    }
+
+    size_t length = total_bytes + 1;
+    if (ftruncate(fd, length) < 0) {
+        string reason = "Unable to size '" + path + "': " + strerror(errno);
+        close(fd);
+        throw runtime_error(reason);
+    }
+
+    void *mapped = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        string reason = "Unable to map '" + path + "': " + strerror(errno);
+        close(fd);
+        throw runtime_error(reason);
+    }
+
+    char *out = (char *) mapped;
+    write(out);
+    out[total_bytes] = '\n';
+
+    munmap(mapped, length);
+    close(fd);
+}
+
+size_t tree_serializer::size() const { return total_bytes; }
+
+/******************************************************************************
+    Threads
+ ******************************************************************************/
+
+/* Starts thread_count - 1 helpers; the calling thread works too */
+void tree_serializer::run_tasks(void (tree_serializer::*work)(size_t, char *), char *out) {
+
+    atomic<size_t> next(0);
+
+    vector<thread> helpers;
+    for (size_t i = 1; i < thread_count && i < tasks.size(); i++) {
+        helpers.push_back(thread(&tree_serializer::task_worker, this, work, out, ref(next)));
+    }
+    task_worker(work, out, next);
+    for (size_t i = 0; i < helpers.size(); i++) {
+        helpers[i].join();
+    }
+}
+
+/* Tasks are handed out one at a time from a shared counter, so a thread that
+draws small subtrees simply takes more of them. */
+void tree_serializer::task_worker(void (tree_serializer::*work)(size_t, char *), char *out, atomic<size_t> &next) {
+    size_t task;
+    while ((task = next++) < tasks.size()) {
+        (this->*work)(task, out);
+    }
+}
+
+void tree_serializer::measure_task_at(size_t task, char *) {
+    measure_task(task);
+}
+
+void tree_serializer::write_task_at(size_t task, char *out) {
+    write_subtree(tasks[task], out + offsets.at(tasks[task]));
+}
@@ -0,0 +1,245 @@
+/*****************************************************************************
+ Title:             tree_serializer.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Serializer Class Definition (Header File)
+                    - Writes the string representation of a tree, or of one
+                        of its subtrees, using several threads:
+                        - a serial pass lays the nodes out in pre-order and
+                            counts the nodes under each one
+                        - the tree is cut into subtrees of about grain nodes,
+                            joined by the few nodes above them
+                        - threads measure how many bytes each subtree prints
+                            as, which fixes where each one starts
+                        - threads then write the subtrees straight into their
+                            final place in one buffer or memory mapped file
+                    - Output in the format of operator << or in Newick format
+                        with branch lengths, identical whatever the number of
+                        threads
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __TREE_SERIALIZER__
+#define __TREE_SERIALIZER__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+/* Format a tree_serializer writes in */
+enum tree_format {
+    PAREN_FORMAT,   // (s1,s2) and organism names, as printed by operator <<
+    NEWICK_FORMAT   // (s1,s2):length and name:length, where length is the
+                    // score difference to the parent, ending in ";". Names
+                    // holding Newick punctuation are quoted, e.g. 'a:b'
+};
+
+class tree_serializer {
+
+private:
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Copy of the tree being written, which keeps its nodes alive
+    binary_tree tree;
+    tree_format format;
+    size_t thread_count;
+
+    // Nodes of the subtree in pre-order. The left child of the node at i is
+    // at i + 1, and its right child at i + 1 + subtree_nodes[i + 1].
+    vector<const tree_node *> nodes;
+    vector<size_t> subtree_nodes;
+
+    // Score difference between each node and its parent (NEWICK_FORMAT only)
+    vector<float> branch_lengths;
+
+    // Bytes printed by the subtree rooted at each node
+    vector<size_t> subtree_bytes;
+
+    // Nodes above the cut, in pre-order, and roots of the subtrees below it
+    vector<size_t> glue;
+    vector<size_t> tasks;
+
+    // Where the output of each of those nodes starts
+    unordered_map<size_t, size_t> offsets;
+
+    // Total bytes of output
+    size_t total_bytes;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* size_t branch_bytes(size_t i) const;
+    Returns the bytes printed after node i for its branch length.
+        @param      size_t i        [in] position of node in pre-order
+        @return     size_t          [out] 0 for the root or in PAREN_FORMAT,
+                                    else length of ":" and the branch length
+        @pre        nodes is filled in.
+        @post       None.
+   */
+    size_t branch_bytes(size_t i) const;
+
+    /* size_t name_bytes(size_t i) const;
+    Returns the bytes printed for the name of leaf i.
+        @param      size_t i        [in] position of leaf in pre-order
+        @return     size_t          [out] length of name, plus its quotes and
+                                    doubled quotes if it is quoted
+        @pre        nodes is filled in.
+        @post       None.
+   */
+    size_t name_bytes(size_t i) const;
+
+    /* size_t write_name(size_t i, char *out) const;
+    Writes the name of leaf i, quoted if the format calls for it.
+        @param      size_t i        [in] position of leaf in pre-order
+        @param      char *out       [out] where to write
+        @return     size_t          [out] bytes written, name_bytes(i)
+        @pre        out has room for name_bytes(i) bytes.
+        @post       Name has been written.
+   */
+    size_t write_name(size_t i, char *out) const;
+
+    /* static bool needs_quotes(const string &name);
+    Returns whether a name must be quoted in Newick format: if it holds a
+    blank, parenthesis, square bracket, single quote, colon, semicolon or
+    comma, or an underscore, which unquoted would be read back as a blank.
+        @param      const string &name  [in] organism name
+        @return     bool                [out] true if it must be quoted
+        @pre        None.
+        @post       None.
+   */
+    static bool needs_quotes(const string &name);
+
+    /* size_t write_branch(size_t i, char *out) const;
+    Writes ":" and the branch length of node i, if it has one.
+        @param      size_t i        [in] position of node in pre-order
+        @param      char *out       [out] where to write
+        @return     size_t          [out] bytes written, branch_bytes(i)
+        @pre        out has room for branch_bytes(i) bytes.
+        @post       Branch length has been written.
+   */
+    size_t write_branch(size_t i, char *out) const;
+
+    /* static int format_length(float length, char *out);
+    Formats a branch length the way operator << formats a float. Measuring and
+    writing both use it, so their byte counts always agree.
+        @param      float length    [in] branch length
+        @param      char *out       [out] at least 32 bytes
+        @return     int             [out] number of characters written
+        @pre        None.
+        @post       out holds the formatted length, NUL terminated.
+   */
+    static int format_length(float length, char *out);
+
+    /* void measure_task(size_t task);
+    Fills in subtree_bytes for every node under a task root, children first.
+        @param      size_t task     [in] index into tasks
+        @pre        nodes and subtree_nodes are filled in.
+        @post       subtree_bytes is set for the task's nodes.
+   */
+    void measure_task(size_t task);
+
+    /* void write_subtree(size_t i, char *out) const;
+    Writes the subtree rooted at node i, without recursing.
+        @param      size_t i        [in] position of subtree root in pre-order
+        @param      char *out       [out] the subtree's place in the output
+        @pre        subtree_bytes is filled in.
+        @post       subtree_bytes[i] bytes have been written to out.
+   */
+    void write_subtree(size_t i, char *out) const;
+
+    /* void run_tasks(void (tree_serializer::*work)(size_t, char *), char *out);
+    Runs work on every task, spread over thread_count threads that each take
+    the next task not yet started.
+        @param      work            [in] function to run for each task
+        @param      char *out       [in] passed on to work
+        @pre        tasks is filled in.
+        @post       work has run once for every task.
+   */
+    void run_tasks(void (tree_serializer::*work)(size_t, char *), char *out);
+
+    /* void task_worker(void (tree_serializer::*work)(size_t, char *), char *out, atomic<size_t> &next);
+    Runs work on tasks taken from next until there are none left.
+        @param      work            [in] function to run for each task
+        @param      char *out       [in] passed on to work
+        @param      atomic<size_t> &next [in/out] index of next task to start
+        @pre        Called by run_tasks(), on any thread.
+        @post       next is past the last task.
+   */
+    void task_worker(void (tree_serializer::*work)(size_t, char *), char *out, atomic<size_t> &next);
+
+    // Adapters to run_tasks()
+    void measure_task_at(size_t task, char *out);
+    void write_task_at(size_t task, char *out);
+
+public:
+
+/******************************************************************************
+     Public Constructor
+******************************************************************************/
+
+    /* tree_serializer(const binary_tree &t, tree_format f = PAREN_FORMAT, size_t threads = 1, const tree_node *subtree = NULL, size_t grain = 0) throw(invalid_argument, bad_alloc);
+    Lays out and measures the tree, or the subtree rooted at subtree.
+        @param      const binary_tree &t    [in] tree to write
+        @param      tree_format f           [in] format to write in
+        @param      size_t threads          [in] number of threads to use
+        @param      const tree_node *subtree [in] node of t to write the
+                                            subtree of, or NULL for all of t
+        @param      size_t grain            [in] most nodes written by one
+                                            task, or 0 to choose from the size
+                                            of the tree and number of threads
+        @pre        t is non-empty and threads is positive.
+        @post       size() is known and the tree is ready to write. Else
+                    throws invalid_argument.
+   */
+    tree_serializer(const binary_tree &t, tree_format f = PAREN_FORMAT, size_t threads = 1,
+                    const tree_node *subtree = NULL, size_t grain = 0) throw(invalid_argument, bad_alloc);
+
+/******************************************************************************
+     Public Functions
+******************************************************************************/
+
+    /* Returns number of bytes the tree is written as, without a newline */
+    size_t size() const;
+
+    /* void write(char *out);
+    Writes the tree into out.
+        @param      char *out       [out] buffer of at least size() bytes
+        @pre        None.
+        @post       out holds the tree's string representation, not NUL
+                    terminated.
+   */
+    void write(char *out);
+
+    /* string str();
+    Returns the tree's string representation.
+        @return     string          [out] size() bytes
+        @pre        None.
+        @post       Same as write() into a string.
+   */
+    string str();
+
+    /* void write_file(const string &path) throw(runtime_error);
+    Writes the tree, followed by a newline, to the file at path by sizing the
+    file and mapping it into memory, so the threads write to it directly.
+        @param      const string &path  [in] file to create or overwrite
+        @pre        None.
+        @post       File holds size() + 1 bytes. Else throws runtime_error.
+   */
+    void write_file(const string &path) throw(runtime_error);
+};
+
+#endif
@@ -0,0 +1,626 @@
+/*****************************************************************************
+ Title:             tree_server.cpp
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Server Implementation
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#include <sstream>
+#include <iomanip>
+#include <utility>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "tree_server.h"
+#include "tree_serializer.h"
+
+// Longest command line accepted; a client that sends more is disconnected
+static const size_t MAX_LINE = 65536;
+
+// Most bytes of replies a client may leave unread before it is disconnected
+static const size_t MAX_OUTBOX = 64 * 1024 * 1024;
+
+/******************************************************************************
+    Constructor and Destructor
+ ******************************************************************************/
+
+/* Copies the tree, which shares its nodes, and builds the copy's name index,
+which every later version inherits and keeps up to date. Threads and sockets
+are only created once the server starts serving. */
+tree_server::tree_server(const binary_tree &tree, size_t workers) throw(invalid_argument, bad_alloc)
+    : snapshot(tree), version(0), index_version(0), worker_count(workers), stopping(false),
+      shutdown_requested(false) {
+
+    if (workers == 0) {
+        throw invalid_argument("Server needs at least one worker thread");
+    }
+    wake_pipe[0] = wake_pipe[1] = -1;
+    snapshot.index_names();
+}
+
+tree_server::~tree_server() {}
+
+/******************************************************************************
+    Serving
+ ******************************************************************************/
+
+/* Creates the socket and wake pipe and starts the workers, then loops until
+shutdown. Each pass polls the wake pipe, the listening socket, every client
+that has not hung up, and every client with replies left to write; accepts new
+clients; writes what each writable client's socket will take; reads whatever
+each readable client sent and splits it into lines; hands the next line of
+every idle client to the workers; and closes clients that have hung up once
+their last reply is written, or at once if their replies cannot be written.
+*/
+void tree_server::serve(const string &socket_path) throw(runtime_error, bad_alloc) {
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        throw runtime_error("Socket path '" + socket_path + "' is empty or too long");
+    }
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw runtime_error(string("Unable to create socket: ") + strerror(errno));
+    }
+
+    // Only a stale socket is removed, never a file that happens to be there.
+    // A socket is stale if connecting to it is refused; one a running server
+    // answers on is left alone.
+    struct stat existing;
+    if (lstat(socket_path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            close(listen_fd);
+            throw runtime_error("Socket path '" + socket_path + "' exists and is not a socket");
+        }
+
+        int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe_fd < 0) {
+            string reason = string("Unable to create socket: ") + strerror(errno);
+            close(listen_fd);
+            throw runtime_error(reason);
+        }
+        int connected = connect(probe_fd, (sockaddr *) &address, sizeof(address));
+        int connect_errno = errno;
+        close(probe_fd);
+
+        if (connected == 0) {
+            close(listen_fd);
+            throw runtime_error("Socket path '" + socket_path + "' is in use by a running server");
+        }
+        if (connect_errno != ECONNREFUSED) {
+            close(listen_fd);
+            throw runtime_error(string("Unable to check socket '") + socket_path + "': " + strerror(connect_errno));
+        }
+        unlink(socket_path.c_str());
+    }
+    if (bind(listen_fd, (sockaddr *) &address, sizeof(address)) < 0 || listen(listen_fd, 64) < 0) {
+        string reason = string("Unable to listen on '") + socket_path + "': " + strerror(errno);
+        close(listen_fd);
+        throw runtime_error(reason);
+    }
+
+    if (pipe(wake_pipe) < 0) {
+        string reason = string("Unable to create wake pipe: ") + strerror(errno);
+        close(listen_fd);
+        unlink(socket_path.c_str());
+        throw runtime_error(reason);
+    }
+    fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+
+    stopping = false;
+    shutdown_requested = false;
+    for (size_t i = 0; i < worker_count; i++) {
+        workers.push_back(thread(&tree_server::worker_loop, this));
+    }
+
+    map<int, shared_ptr<client_state> > clients;
+    vector<pollfd> fds;
+    char buffer[4096];
+
+    while (!shutdown_requested) {
+
+        fds.clear();
+        pollfd wake_fd = { wake_pipe[0], POLLIN, 0 };
+        pollfd accept_fd = { listen_fd, POLLIN, 0 };
+        fds.push_back(wake_fd);
+        fds.push_back(accept_fd);
+        for (map<int, shared_ptr<client_state> >::iterator it = clients.begin(); it != clients.end(); ++it) {
+            client_state &client = *it->second;
+            if (client.failed) {
+                continue;
+            }
+
+            short events = client.closing ? 0 : POLLIN;
+            {
+                lock_guard<mutex> lock(client.outbox_mutex);
+                if (!client.outbox.empty()) {
+                    events |= POLLOUT;
+                }
+            }
+            if (events != 0) {
+                pollfd client_fd = { it->first, events, 0 };
+                fds.push_back(client_fd);
+            }
+        }
+
+        if (poll(&fds[0], fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        // Finished commands only need the loop to run again
+        if (fds[0].revents & POLLIN) {
+            while (read(wake_pipe[0], buffer, sizeof(buffer)) > 0) {}
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int client_fd = accept(listen_fd, NULL, NULL);
+            if (client_fd >= 0) {
+                fcntl(client_fd, F_SETFL, O_NONBLOCK);
+                clients[client_fd] = shared_ptr<client_state>(new client_state(client_fd));
+            }
+        }
+
+        for (size_t i = 2; i < fds.size(); i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            client_state &client = *clients[fds[i].fd];
+
+            if (fds[i].revents & POLLOUT) {
+                flush(client);
+            }
+            if (client.closing || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+
+            ssize_t count = read(client.fd, buffer, sizeof(buffer));
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                continue;
+            }
+            if (count <= 0) {
+                client.closing = true;
+                continue;
+            }
+
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            client.buffer.append(buffer, count);
+
+            size_t start = 0, end;
+            while ((end = client.buffer.find('\n', start)) != string::npos) {
+                pending_command command;
+                command.line = client.buffer.substr(start, end - start);
+                command.received = now;
+                if (!command.line.empty() && command.line[command.line.size() - 1] == '\r') {
+                    command.line.erase(command.line.size() - 1);
+                }
+                if (!command.line.empty()) {
+                    client.pending.push_back(command);
+                }
+                start = end + 1;
+            }
+            client.buffer.erase(0, start);
+
+            if (client.buffer.size() > MAX_LINE) {
+                client.closing = true;
+            }
+        }
+
+        // Hand out the next command of every idle client, drop clients with
+        // too many unread replies, and close clients that are done
+        for (map<int, shared_ptr<client_state> >::iterator it = clients.begin(); it != clients.end(); ) {
+            shared_ptr<client_state> client = it->second;
+
+            bool outbox_empty;
+            {
+                lock_guard<mutex> lock(client->outbox_mutex);
+                if (client->outbox.size() > MAX_OUTBOX) {
+                    client->failed = true;
+                }
+                outbox_empty = client->outbox.empty();
+            }
+            if (client->failed) {
+                client->pending.clear();
+            }
+
+            if (!client->busy && !client->pending.empty()) {
+                command_job job;
+                job.client = client;
+                job.command = client->pending.front();
+                client->pending.pop_front();
+                client->busy = true;
+
+                lock_guard<mutex> lock(job_mutex);
+                jobs.push_back(job);
+                job_ready.notify_one();
+            }
+
+            bool done = client->failed || (client->closing && client->pending.empty() && outbox_empty);
+            if (done && !client->busy) {
+                close(client->fd);
+                clients.erase(it++);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    // Stop the workers, dropping commands that have not started
+    {
+        lock_guard<mutex> lock(job_mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    job_ready.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+
+    // Last replies, such as the one to shutdown, are written if the socket
+    // takes them at once
+    for (map<int, shared_ptr<client_state> >::iterator it = clients.begin(); it != clients.end(); ++it) {
+        if (!it->second->failed) {
+            flush(*it->second);
+        }
+        close(it->first);
+    }
+    close(listen_fd);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    wake_pipe[0] = wake_pipe[1] = -1;
+    unlink(socket_path.c_str());
+}
+
+/* Runs commands until the pool is stopped. The reply goes into the client's
+outbox for the poll loop to write; only then is the client marked idle, so the
+loop cannot hand out its next command before the reply is queued. */
+void tree_server::worker_loop() {
+
+    while (true) {
+        command_job job;
+        {
+            unique_lock<mutex> lock(job_mutex);
+            while (!stopping && jobs.empty()) {
+                job_ready.wait(lock);
+            }
+            if (stopping) {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        string command;
+        bool ok = true;
+        string result = execute(job.command.line, command, ok);
+
+        chrono::nanoseconds latency = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - job.command.received);
+        record(command, ok, latency);
+
+        ostringstream reply;
+        reply << (ok ? "OK " : "ERROR ") << latency.count() / 1000 << "us " << result << "\n";
+        {
+            lock_guard<mutex> lock(job.client->outbox_mutex);
+            job.client->outbox += reply.str();
+        }
+
+        job.client->busy = false;
+        wake();
+    }
+}
+
+/* The socket is non-blocking, so this stops as soon as the socket's buffer is
+full; the poll loop asks to hear when there is room again. */
+void tree_server::flush(client_state &client) {
+
+    lock_guard<mutex> lock(client.outbox_mutex);
+    size_t sent = 0;
+    while (sent < client.outbox.size()) {
+        ssize_t count = send(client.fd, client.outbox.data() + sent, client.outbox.size() - sent, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (count <= 0) {
+            client.failed = true;
+            break;
+        }
+        sent += count;
+    }
+    client.outbox.erase(0, sent);
+}
+
+/* Wakes the poll loop. If the pipe is full, the loop is already due to wake. */
+void tree_server::wake() {
+    char byte = 0;
+    ssize_t ignored = write(wake_pipe[1], &byte, 1);
+    (void) ignored;
+}
+
+/******************************************************************************
+    Commands
+ ******************************************************************************/
+
+/* Splits off the command name and dispatches on it. Reads take a snapshot and
+work on it undisturbed. Updates take the update lock, apply the change to a
+copy of the latest snapshot, which path-copies only the nodes above the change,
+and publish the copy; the snapshot lock itself is only held to swap roots. */
+string tree_server::execute(const string &line, string &command, bool &ok) {
+
+    istringstream words(line);
+    words >> command;
+
+    string arguments;
+    getline(words >> ws, arguments);
+
+    ok = true;
+    try {
+        if (command == "add") {
+            lock_guard<mutex> writer(update_mutex);
+            binary_tree updated = current_snapshot();
+            updated.add_organism(arguments);
+            publish(updated);
+            return "added";
+        }
+
+        if (command == "remove") {
+            lock_guard<mutex> writer(update_mutex);
+            binary_tree updated = current_snapshot();
+            updated.remove_organism(arguments);
+            publish(updated);
+            return "removed";
+        }
+
+        if (command == "print") {
+            binary_tree tree = current_snapshot();
+            if (tree.get_root_ptr() == NULL) {
+                throw invalid_argument("Tree is empty");
+            }
+
+            // Organisms are found through the name index; only the names of
+            // combined trees, which it does not hold, need a search
+            const tree_node *subtree_root = tree.get_root_ptr();
+            if (!arguments.empty()) {
+                vector<pair<tree_node *, bool> > path;
+                subtree_root = find_organism(tree, arguments, path);
+                tree_range nodes = tree.pre_order();
+                for (tree_iterator it = nodes.begin(); subtree_root == NULL && it != nodes.end(); ++it) {
+                    if (!it->is_leaf() && it->get_name() == arguments) {
+                        subtree_root = &*it;
+                    }
+                }
+                if (subtree_root == NULL) {
+                    throw invalid_argument("'" + arguments + "' is not a node in the tree");
+                }
+            }
+
+            return tree_serializer(tree, PAREN_FORMAT, 1, subtree_root).str();
+        }
+
+        if (command == "related") {
+            istringstream names(arguments);
+            string first, second, extra;
+            names >> first >> second;
+            if (first.empty() || second.empty() || (names >> extra)) {
+                throw invalid_argument("Usage: related <name> <name>");
+            }
+            return related(current_snapshot(), first, second);
+        }
+
+        if (command == "range") {
+            istringstream numbers(arguments);
+            float low, high;
+            string extra;
+            if (!(numbers >> low >> high) || (numbers >> extra)) {
+                throw invalid_argument("Usage: range <low> <high>");
+            }
+            return list_organisms(current_index()->scores_between(low, high));
+        }
+
+        if (command == "nearest") {
+            istringstream numbers(arguments);
+            float score;
+            long k;
+            string extra;
+            if (!(numbers >> score >> k) || k < 0 || (numbers >> extra)) {
+                throw invalid_argument("Usage: nearest <score> <k>");
+            }
+            return list_organisms(current_index()->nearest(score, k));
+        }
+
+        if (command == "stats") {
+            ostringstream out;
+            print_stats(out);
+            string lines = out.str();
+            for (size_t i = 0; i < lines.size(); i++) {
+                if (lines[i] == '\n') {
+                    lines[i] = ';';
+                }
+            }
+            return lines;
+        }
+
+        if (command == "shutdown") {
+            shutdown_requested = true;
+            return "shutting down";
+        }
+
+        string unknown = command;
+        command = "unknown";
+        throw invalid_argument("Unknown command '" + unknown + "'. Commands are add, remove, print, related, range, nearest, stats and shutdown");
+    }
+    catch (invalid_argument &ia) {
+        ok = false;
+        return ia.what();
+    }
+    catch (bad_alloc &ba) {
+        ok = false;
+        return "Failure to allocate memory";
+    }
+}
+
+/* Finds the path from the root to each organism through the name index. The
+paths agree down to the
+common ancestor; each organism is then as many edges below it as its path has
+nodes past that point. */
+string tree_server::related(const binary_tree &tree, const string &first, const string &second) const throw(invalid_argument) {
+
+    vector<pair<tree_node *, bool> > first_path, second_path;
+    if (find_organism(tree, first, first_path) == NULL) {
+        throw invalid_argument("'" + first + "' is not an organism in the tree");
+    }
+    if (find_organism(tree, second, second_path) == NULL) {
+        throw invalid_argument("'" + second + "' is not an organism in the tree");
+    }
+
+    ostringstream out;
+    if (first == second) {
+        out << first << " height 0 edges 0";
+        return out.str();
+    }
+
+    size_t shared = 0;
+    while (shared < first_path.size() && shared < second_path.size()
+           && first_path[shared].first == second_path[shared].first
+           && first_path[shared].second == second_path[shared].second) {
+        shared++;
+    }
+
+    // Both paths run through the ancestor, then turn different ways below it
+    const tree_node *ancestor = first_path[shared].first;
+    size_t edges = (first_path.size() - shared) + (second_path.size() - shared);
+
+    out << ancestor->get_name() << " height " << ancestor->get_height() << " edges " << edges;
+    return out.str();
+}
+
+/* Looks up the organism's score, then walks down to it by score range */
+const tree_node *tree_server::find_organism(const binary_tree &tree, const string &name,
+                                            vector<pair<tree_node *, bool> > &path) {
+    float score;
+    path.clear();
+    if (!binary_tree::find_name(tree.names, name, score) || !tree.find_leaf(name, score, path)) {
+        return NULL;
+    }
+    if (path.empty()) {
+        return tree.root;
+    }
+    return path.back().second ? path.back().first->get_left() : path.back().first->get_right();
+}
+
+/* e.g. "2 organisms: ape 10, human 12" or "0 organisms" */
+string tree_server::list_organisms(const leaf_range &found) {
+    ostringstream out;
+    out << found.size() << (found.size() == 1 ? " organism" : " organisms");
+    if (found.size() > 0) {
+        out << ": " << found;
+    }
+    return out.str();
+}
+
+/******************************************************************************
+    Snapshots
+ ******************************************************************************/
+
+binary_tree tree_server::current_snapshot() const {
+    lock_guard<mutex> lock(snapshot_mutex);
+    return snapshot;
+}
+
+/* Builds the index outside the lock, so that reads and updates carry on
+meanwhile. If the tree was updated in the meantime, the index is still returned
+for this query, which reads the version it was given, but not kept. */
+shared_ptr<const leaf_index> tree_server::current_index() throw(invalid_argument, bad_alloc) {
+
+    binary_tree tree;
+    unsigned long indexed_version;
+    {
+        lock_guard<mutex> lock(snapshot_mutex);
+        if (index && index_version == version) {
+            return index;
+        }
+        tree = snapshot;
+        indexed_version = version;
+    }
+
+    shared_ptr<const leaf_index> built(new leaf_index(tree));
+
+    lock_guard<mutex> lock(snapshot_mutex);
+    if (indexed_version == version) {
+        index = built;
+        index_version = indexed_version;
+    }
+    return built;
+}
+
+/* Keeps a reference to the old root until the lock is released, so that any
+nodes only the old version used are freed outside the lock. */
+void tree_server::publish(const binary_tree &tree) {
+    binary_tree previous;
+    {
+        lock_guard<mutex> lock(snapshot_mutex);
+        previous = snapshot;
+        snapshot = tree;
+        version++;
+    }
+}
+
+/******************************************************************************
+    Statistics
+ ******************************************************************************/
+
+void tree_server::record(const string &command, bool ok, chrono::nanoseconds latency) {
+    lock_guard<mutex> lock(stats_mutex);
+    command_stats &totals = stats[command];
+    totals.count++;
+    if (!ok) {
+        totals.failed++;
+    }
+    totals.total += latency;
+    if (latency > totals.longest) {
+        totals.longest = latency;
+    }
+}
+
+/* Prints one line per command that has run, followed by the current version
+of the tree. Latencies are in microseconds. */
+void tree_server::print_stats(ostream &os) const {
+
+    {
+        lock_guard<mutex> lock(stats_mutex);
+        for (map<string, command_stats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+            const command_stats &totals = it->second;
+            os << "command " << left << setw(9) << it->first << right
+               << " count " << setw(8) << totals.count
+               << " failed " << setw(8) << totals.failed << fixed << setprecision(1)
+               << " avg " << setw(10) << totals.total.count() / 1e3 / totals.count << " us"
+               << " max " << setw(10) << totals.longest.count() / 1e3 << " us" << endl;
+            os.unsetf(ios::floatfield);
+            os << setprecision(6);
+        }
+    }
+
+    lock_guard<mutex> lock(snapshot_mutex);
+    os << "tree version " << version << endl;
+}
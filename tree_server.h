@@ -0,0 +1,323 @@
+/*****************************************************************************
+ Title:             tree_server.h
+ Author:            Anna Cristina Karingal
+ Created on:        October 18, 2026
+ Description:       Tree Server Class Definition (Header File)
+                    - Keeps an organism tree in memory and answers commands,
+                        one per line, from clients of a Unix domain socket:
+                        - add <name> <score>    adds an organism
+                        - remove <name>         removes an organism
+                        - print [<name>]        prints the whole tree, or the
+                                                    subtree rooted at a node
+                        - related <a> <b>       nearest common ancestor of two
+                                                    organisms, its merge height
+                                                    and the number of edges
+                                                    between them
+                        - range <low> <high>    organisms with scores from low
+                                                    to high
+                        - nearest <score> <k>   the k organisms closest in
+                                                    score
+                        - stats                 per-command latencies
+                        - shutdown              stops the server
+                    - One poll() loop accepts clients, reads commands and
+                        writes replies; a pool of worker threads runs them.
+                        Each client has at most one command running at a
+                        time, so its replies arrive in order. Replies wait in
+                        a per-client outbox, so a client that stops reading
+                        never holds up a worker; one whose unread replies
+                        pile up is dropped.
+                    - Commands read an immutable snapshot of the tree. Updates
+                        are made on a copy and then published, so a read never
+                        waits for an update to finish.
+                    - Score queries read a leaf index of the snapshot, built
+                        by the first query after each update. related and
+                        print <name> find organisms through the name index
+                        the snapshot shares with every later version, in time
+                        proportional to their depth.
+
+ Last Modified:     October 18, 2026
+
+ *****************************************************************************/
+
+#ifndef __TREE_SERVER__
+#define __TREE_SERVER__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+
+#include "binary_tree.h"
+#include "leaf_index.h"
+
+using namespace std;
+
+class tree_server {
+
+private:
+
+/******************************************************************************
+     Private types
+******************************************************************************/
+
+    // A command line and the time its last byte was read
+    struct pending_command {
+        string line;
+        chrono::steady_clock::time_point received;
+    };
+
+    // A connected client. Only the poll loop reads from or writes to fd.
+    // Workers only append to outbox and clear busy.
+    struct client_state {
+        int fd;                             // non-blocking
+        string buffer;                      // bytes read after the last newline
+        deque<pending_command> pending;     // complete lines not yet run
+        bool closing;                       // peer hung up or sent too much;
+                                            // close once replies are written
+        bool failed;                        // replies cannot be written or
+                                            // piled up; close at once
+        atomic<bool> busy;                  // a worker is running its command
+        string outbox;                      // replies not yet written
+        mutex outbox_mutex;                 // guards outbox
+        client_state(int f) : fd(f), closing(false), failed(false), busy(false) {}
+    };
+
+    // A command handed to the worker pool
+    struct command_job {
+        shared_ptr<client_state> client;
+        pending_command command;
+    };
+
+    // Latency totals of one kind of command
+    struct command_stats {
+        size_t count;
+        size_t failed;
+        chrono::nanoseconds total;
+        chrono::nanoseconds longest;
+        command_stats() : count(0), failed(0), total(0), longest(0) {}
+    };
+
+/******************************************************************************
+     Private member variables
+******************************************************************************/
+
+    // Latest published version of the tree. Only held long enough to copy or
+    // replace the root pointer, which is O(1).
+    binary_tree snapshot;
+    unsigned long version;
+    mutable mutex snapshot_mutex;
+
+    // Leaf index of the snapshot as of index_version, or NULL if not yet
+    // built. Guarded by snapshot_mutex.
+    shared_ptr<const leaf_index> index;
+    unsigned long index_version;
+
+    // Held for the whole of an update, so that updates are applied one at a
+    // time and none is lost
+    mutex update_mutex;
+
+    // Worker pool and the commands waiting for a worker
+    size_t worker_count;
+    vector<thread> workers;
+    deque<command_job> jobs;
+    mutex job_mutex;
+    condition_variable job_ready;
+    bool stopping;
+
+    // Set by the shutdown command
+    atomic<bool> shutdown_requested;
+
+    // Written to by a worker when it finishes a command, to wake the poll loop
+    int wake_pipe[2];
+
+    // Latency totals by command name
+    map<string, command_stats> stats;
+    mutable mutex stats_mutex;
+
+/******************************************************************************
+     Private Helper Functions
+******************************************************************************/
+
+    /* void worker_loop();
+    Takes commands off the job queue, runs them, and sends each reply to the
+    client that sent it.
+        @pre        Called from its own thread.
+        @post       Returns once the pool is stopped.
+   */
+    void worker_loop();
+
+    /* string execute(const string &line, string &command, bool &ok);
+    Runs a single command line.
+        @param      const string &line  [in] command and its arguments
+        @param      string &command     [out] name of command, for statistics
+        @param      bool &ok            [out] whether the command succeeded
+        @return     string              [out] reply, without status or latency
+        @pre        None.
+        @post       Updates have been published. Errors are returned as the
+                    reply with ok set to false.
+   */
+    string execute(const string &line, string &command, bool &ok);
+
+    /* binary_tree current_snapshot() const;
+    Returns the latest published version of the tree.
+        @return     binary_tree     [out] copy sharing the snapshot's nodes
+        @pre        None.
+        @post       Snapshot is unchanged. Takes O(1).
+   */
+    binary_tree current_snapshot() const;
+
+    /* shared_ptr<const leaf_index> current_index() throw(invalid_argument, bad_alloc);
+    Returns a leaf index of the latest published version of the tree, building
+    it if that version has not been indexed yet.
+        @return     shared_ptr<const leaf_index>    [out] index of the snapshot
+        @pre        None.
+        @post       The index is kept for later queries, unless the tree was
+                    updated while it was built. The snapshot lock is not held
+                    while building. Else throws invalid_argument.
+   */
+    shared_ptr<const leaf_index> current_index() throw(invalid_argument, bad_alloc);
+
+    /* void publish(const binary_tree &tree);
+    Makes tree the latest version. Readers holding the old version keep it.
+        @param      const binary_tree &tree [in] updated tree
+        @pre        update_mutex is held.
+        @post       snapshot shares tree's nodes and version is incremented.
+   */
+    void publish(const binary_tree &tree);
+
+    /* string related(const binary_tree &tree, const string &first, const string &second) const throw(invalid_argument);
+    Finds the nearest common ancestor of two organisms.
+        @param      const binary_tree &tree [in] version of tree to search
+        @param      const string &first     [in] name of first organism
+        @param      const string &second    [in] name of second organism
+        @return     string                  [out] ancestor's name, its merge
+                                            height and the number of edges
+                                            on the path between the organisms
+        @pre        None.
+        @post       Else throws invalid_argument if either is not in tree.
+   */
+    string related(const binary_tree &tree, const string &first, const string &second) const throw(invalid_argument);
+
+    /* static const tree_node *find_organism(const binary_tree &tree, const string &name, vector<pair<tree_node *, bool> > &path);
+    Finds the leaf holding an organism through the tree's name index.
+        @param      const binary_tree &tree [in] version of tree to search
+        @param      const string &name      [in] name of organism
+        @param      vector<pair<tree_node *, bool> > &path  [out] ancestors of
+                                            the leaf, as for find_leaf()
+        @return     const tree_node *       [out] the leaf, or NULL if name is
+                                            not an organism in tree
+        @pre        tree's name index has been built.
+        @post       If found, path leads from the root to the leaf's parent.
+                    Takes time proportional to the depth of the leaf.
+   */
+    static const tree_node *find_organism(const binary_tree &tree, const string &name,
+                                          vector<pair<tree_node *, bool> > &path);
+
+    /* static string list_organisms(const leaf_range &found);
+    Formats the answer to a score query.
+        @param      const leaf_range &found [in] leaves found
+        @return     string                  [out] number of leaves, then the
+                                            name and score of each
+        @pre        None.
+        @post       None.
+   */
+    static string list_organisms(const leaf_range &found);
+
+    /* void record(const string &command, bool ok, chrono::nanoseconds latency);
+    Adds one command's latency to the statistics.
+        @param      const string &command       [in] name of command
+        @param      bool ok                     [in] whether it succeeded
+        @param      chrono::nanoseconds latency [in] time from receipt to reply
+        @pre        None.
+        @post       Totals for command are updated.
+   */
+    void record(const string &command, bool ok, chrono::nanoseconds latency);
+
+    /* void flush(client_state &client);
+    Writes as much of a client's outbox as its socket will take without
+    blocking.
+        @param      client_state &client    [in/out] client to write to
+        @pre        Called from the poll loop.
+        @post       Written bytes are removed from the outbox. If the socket
+                    fails, the client is marked failed.
+   */
+    void flush(client_state &client);
+
+    /* void wake();
+    Wakes the poll loop so it can hand out a finished client's next command.
+        @pre        wake_pipe is open.
+        @post       A byte has been written to the wake pipe.
+   */
+    void wake();
+
+    // Not copyable: the server owns threads and file descriptors
+    tree_server(const tree_server &);
+    tree_server &operator = (const tree_server &);
+
+public:
+
+/******************************************************************************
+     Public Constructor and Destructor
+******************************************************************************/
+
+    /* tree_server(const binary_tree &tree, size_t workers = 4) throw(invalid_argument, bad_alloc);
+    Creates a server for tree with a pool of workers threads.
+        @param      const binary_tree &tree [in] tree to serve. Shares its
+                                            nodes; tree itself is never changed.
+        @param      size_t workers          [in] number of worker threads
+        @pre        workers is positive.
+        @post       A server ready to serve, with the name index of its copy
+                    of the tree built. Else throws invalid_argument.
+   */
+    tree_server(const binary_tree &tree, size_t workers = 4) throw(invalid_argument, bad_alloc);
+
+    /* ~tree_server();
+    Destroys the server and releases its version of the tree.
+        @pre        serve() is not running.
+        @post       Server is destroyed.
+   */
+    ~tree_server();
+
+/******************************************************************************
+     Public Functions
+******************************************************************************/
+
+    /* void serve(const string &socket_path) throw(runtime_error, bad_alloc);
+    Listens on a Unix domain socket at socket_path and answers commands until
+    a client sends shutdown. Every reply is one line:
+        OK <latency>us <result>     or      ERROR <latency>us <reason>
+    where latency is the time from reading the command to finishing it.
+        @param      const string &socket_path   [in] path to create socket at.
+                                                A stale socket already there,
+                                                which refuses connections, is
+                                                removed; a socket a running
+                                                server answers on, or any
+                                                other file, is left alone.
+        @pre        Not already serving.
+        @post       Socket has been closed and removed, and workers stopped.
+                    Else throws runtime_error if the socket cannot be set up,
+                    or if something other than a stale socket is at
+                    socket_path.
+   */
+    void serve(const string &socket_path) throw(runtime_error, bad_alloc);
+
+    /* void print_stats(ostream &os) const;
+    Prints, for each command, how often it ran, how often it failed and its
+    average and longest latency.
+        @param      ostream &os     [in/out] stream to write statistics to
+        @pre        None.
+        @post       Statistics are written to os, one line per command.
+   */
+    void print_stats(ostream &os) const;
+};
+
+#endif
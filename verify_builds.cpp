@@ -0,0 +1,72 @@
+/*******************************************************************************
+ Title          : verify_builds.cpp
+ Author         : Anna Cristina Karingal
+ Created on     : October 18, 2026
+
+ Description    : Checks that every build engine, building from a list and
+                    through the pipeline, and printing with one and with
+                    several threads, gives the tree built by the reference
+                    engine, for an input file and for generated inputs.
+
+ Usage          : ./verify_builds organisms.txt <n> [--seed <s>]
+ (organisms.txt is checked first, then n generated inputs made from seed s, 1
+ by default. Any input the builds disagree on is shrunk to a small input that
+ still shows the difference, and the program exits with an error.)
+
+ Build with     : g++ -std=c++11 -pthread -O2 -o verify_builds verify_builds.cpp build_verifier.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp pipeline.cpp tree_serializer.cpp
+
+ Last modified  : October 18, 2026
+
+ *******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include "build_verifier.h"
+
+using namespace std;
+
+int main(int argc, const char * argv[]) {
+
+    long cases = (argc >= 3) ? atol(argv[2]) : -1;
+    unsigned long seed = 1;
+    bool valid_args = (cases >= 0);
+
+    for (int i = 3; i < argc && valid_args; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else {
+            valid_args = false;
+        }
+    }
+
+    if (!valid_args) {
+        cerr << "ERROR: Invalid arguments" << endl;
+        cerr << "Usage: ./verify_builds organisms.txt <n> [--seed <s>]" << endl;
+        exit(-1);
+    }
+
+    ifstream readf(argv[1]);
+    if (readf.fail()) {
+        cerr << "ERROR: Invalid file. Please check your file name and try again." << endl;
+        exit(-1);
+    }
+
+    vector<string> lines;
+    string line;
+    while (getline(readf, line)) {
+        lines.push_back(line);
+    }
+    readf.close();
+
+    build_verifier verifier(seed);
+    if (!verifier.check(lines, cout) || !verifier.run(cases, cout)) {
+        exit(-1);
+    }
+    return 0;
+}
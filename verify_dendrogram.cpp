@@ -0,0 +1,279 @@
+/*******************************************************************************
+ Title          : verify_dendrogram.cpp
+ Author         : Anna Cristina Karingal
+ Created on     : October 18, 2026
+
+ Description    : Checks dendrogram_index against a brute force walk of the
+                    tree it was built from, on random trees: cut() and
+                    cluster_of() at every merge height and between them, and
+                    top_clusters() for every number of clusters.
+
+ Usage          : ./verify_dendrogram [<trees>] [--seed <s>]
+ (trees is the number of random trees checked, 2000 by default, made from seed
+ s, 1 by default. The first difference found is printed and the program exits
+ with an error.)
+
+ Build with     : g++ -std=c++11 -pthread -O2 -o verify_dendrogram verify_dendrogram.cpp dendrogram_index.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp
+
+ Last modified  : October 18, 2026
+
+ *******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "binary_tree.h"
+#include "dendrogram_index.h"
+
+using namespace std;
+
+/* Builds trees of any shape by joining two trees directly, and exposes the
+root so the brute force walk can descend from it. */
+class test_tree : public binary_tree {
+
+public:
+    test_tree() {}
+    test_tree(const string &organism) : binary_tree(organism) {}
+    test_tree(test_tree &tree1, test_tree &tree2) : binary_tree(tree1, tree2) {}
+    const tree_node *root() const { return get_root_ptr(); }
+};
+
+/* Builds a tree of n organisms by joining two random trees until one is left.
+Scores are drawn from a small range half the time, so that merge heights tie
+and a parent can be lower than its children. */
+static test_tree random_tree(size_t n, mt19937 &random) {
+
+    bool tied = (random() % 2 == 0);
+    vector<test_tree> trees;
+    for (size_t i = 0; i < n; i++) {
+        ostringstream organism;
+        organism << "org" << i << " ";
+        if (tied) {
+            organism << random() % 8;
+        }
+        else {
+            organism << uniform_real_distribution<float>(0, 1000)(random);
+        }
+        trees.push_back(test_tree(organism.str()));
+    }
+
+    while (trees.size() > 1) {
+        size_t a = random() % trees.size();
+        size_t b = random() % (trees.size() - 1);
+        if (b >= a) {
+            b++;
+        }
+        test_tree joined(trees[a], trees[b]);
+        trees[min(a, b)] = joined;
+        trees.erase(trees.begin() + max(a, b));
+    }
+    return trees[0];
+}
+
+/******************************************************************************
+                                BRUTE FORCE
+ ******************************************************************************/
+
+/* What the brute force walk knows about one node: the leaf positions it spans
+and its merge height raised to the largest height below it. */
+struct node_span {
+    const tree_node *node;
+    int first, last;
+    float height;
+};
+
+/* Numbers leaves in print order and records every node's span, children
+before parents. Returns the index of tn_ptr's span. */
+static int walk(const tree_node *tn_ptr, vector<string> &leaves, vector<node_span> &spans,
+                map<const tree_node *, int> &index) {
+
+    node_span span;
+    span.node = tn_ptr;
+    if (tn_ptr->is_leaf()) {
+        span.first = span.last = leaves.size();
+        span.height = tn_ptr->get_height();
+        leaves.push_back(tn_ptr->get_name());
+    }
+    else {
+        const node_span left = spans[walk(tn_ptr->get_left(), leaves, spans, index)];
+        const node_span right = spans[walk(tn_ptr->get_right(), leaves, spans, index)];
+        span.first = left.first;
+        span.last = right.last;
+        span.height = max(tn_ptr->get_height(), max(left.height, right.height));
+    }
+    spans.push_back(span);
+    index[tn_ptr] = spans.size() - 1;
+    return spans.size() - 1;
+}
+
+/* Labels each leaf with the first leaf of the highest subtree above it whose
+merges are all <= max_gap_allowed. */
+static void brute_cut(const tree_node *tn_ptr, float max_gap_allowed, const vector<node_span> &spans,
+                      const map<const tree_node *, int> &index, vector<int> &labels) {
+
+    const node_span &span = spans[index.find(tn_ptr)->second];
+    if (tn_ptr->is_leaf() || span.height <= max_gap_allowed) {
+        for (int i = span.first; i <= span.last; i++) {
+            labels[i] = span.first;
+        }
+    }
+    else {
+        brute_cut(tn_ptr->get_left(), max_gap_allowed, spans, index, labels);
+        brute_cut(tn_ptr->get_right(), max_gap_allowed, spans, index, labels);
+    }
+}
+
+/* Checks that labels split the tree into whole subtrees, each labelled by its
+first leaf, by undoing merges no lower than any merge kept. Descends from
+tn_ptr while a node's leaves are split between clusters, recording the heights
+of the merges undone and of the clusters' roots. */
+static bool split_into_subtrees(const tree_node *tn_ptr, const vector<int> &labels,
+                                const vector<node_span> &spans, const map<const tree_node *, int> &index,
+                                multiset<float> &undone, multiset<float> &kept, size_t &clusters) {
+
+    const node_span &span = spans[index.find(tn_ptr)->second];
+    bool whole = true;
+    for (int i = span.first; i <= span.last; i++) {
+        whole = whole && labels[i] == labels[span.first];
+    }
+    if (whole) {
+        // Its label must not be used outside it
+        for (size_t i = 0; i < labels.size(); i++) {
+            if (((int) i < span.first || (int) i > span.last) && labels[i] == labels[span.first]) {
+                return false;
+            }
+        }
+        if (labels[span.first] != span.first) {
+            return false;
+        }
+        if (!tn_ptr->is_leaf()) {
+            kept.insert(span.height);
+        }
+        clusters++;
+        return true;
+    }
+    undone.insert(span.height);
+    return split_into_subtrees(tn_ptr->get_left(), labels, spans, index, undone, kept, clusters)
+        && split_into_subtrees(tn_ptr->get_right(), labels, spans, index, undone, kept, clusters);
+}
+
+/* Checks one tree, writing the first difference to difference. */
+static bool check_tree(const test_tree &tree, string &difference) {
+
+    vector<string> leaves;
+    vector<node_span> spans;
+    map<const tree_node *, int> index;
+    walk(tree.root(), leaves, spans, index);
+
+    dendrogram_index dendrogram(tree);
+    if (dendrogram.names() != leaves) {
+        difference = "leaf names differ from print order";
+        return false;
+    }
+
+    // Every merge height, a little above and below each, and beyond both ends
+    vector<float> thresholds;
+    thresholds.push_back(-1);
+    for (size_t i = 0; i < spans.size(); i++) {
+        thresholds.push_back(spans[i].height);
+        thresholds.push_back(spans[i].height + 0.25f);
+        thresholds.push_back(spans[i].height - 0.25f);
+    }
+
+    for (size_t t = 0; t < thresholds.size(); t++) {
+        vector<int> expected(leaves.size());
+        brute_cut(tree.root(), thresholds[t], spans, index, expected);
+
+        ostringstream at;
+        at << " at gap " << thresholds[t];
+        if (dendrogram.cut(thresholds[t]) != expected) {
+            difference = "cut" + at.str();
+            return false;
+        }
+        for (size_t i = 0; i < leaves.size(); i++) {
+            if (dendrogram.cluster_of(leaves[i], thresholds[t]) != expected[i]) {
+                difference = "cluster_of(" + leaves[i] + ")" + at.str();
+                return false;
+            }
+        }
+    }
+
+    for (size_t k = 0; k <= leaves.size() + 1; k++) {
+        size_t wanted = max((size_t) 1, min(k, leaves.size()));
+        multiset<float> undone, kept;
+        size_t clusters = 0;
+        ostringstream which;
+        which << "top_clusters(" << k << ")";
+
+        if (!split_into_subtrees(tree.root(), dendrogram.top_clusters(k), spans, index, undone, kept, clusters)) {
+            difference = which.str() + " is not a set of whole subtrees labelled by first leaf";
+            return false;
+        }
+        if (clusters != wanted) {
+            ostringstream got;
+            got << which.str() << " gave " << clusters << " clusters";
+            difference = got.str();
+            return false;
+        }
+        if (!undone.empty() && !kept.empty() && *undone.begin() < *kept.rbegin()) {
+            difference = which.str() + " undid a merge lower than one it kept";
+            return false;
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+                                MAIN PROGRAM
+ ******************************************************************************/
+
+int main(int argc, const char * argv[]) {
+
+    long trees = 2000;
+    unsigned long seed = 1;
+    bool valid_args = true;
+
+    for (int i = 1; i < argc && valid_args; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else if (i == 1) {
+            trees = atol(argv[i]);
+            valid_args = (trees > 0);
+        }
+        else {
+            valid_args = false;
+        }
+    }
+
+    if (!valid_args) {
+        cerr << "ERROR: Invalid arguments" << endl;
+        cerr << "Usage: ./verify_dendrogram [<trees>] [--seed <s>]" << endl;
+        exit(-1);
+    }
+
+    mt19937 random(seed);
+    for (long t = 0; t < trees; t++) {
+        size_t n = 1 + random() % 40;
+        test_tree tree = random_tree(n, random);
+
+        string difference;
+        if (!check_tree(tree, difference)) {
+            cout << "MISMATCH on tree " << t + 1 << " of " << trees << " (" << n << " organisms): "
+                 << difference << endl;
+            cout << "    " << tree;
+            exit(-1);
+        }
+    }
+
+    cout << "Verified cut, cluster_of and top_clusters on " << trees << " random trees" << endl;
+    return 0;
+}
@@ -0,0 +1,334 @@
+/*******************************************************************************
+ Title          : verify_diff.cpp
+ Author         : Anna Cristina Karingal
+ Created on     : October 18, 2026
+
+ Description    : Checks tree_diff against a brute force comparison of random
+                    pairs of trees, where the second tree regroups whole
+                    subtrees of the first and may add, remove or rescore
+                    organisms:
+                    - identical() holds exactly when both trees have the same
+                        names, scores and shape
+                    - added(), removed() and rescored() are exactly the
+                        organisms only in one tree or with a new score
+                    - every organism with a sibling in both trees whose
+                        sibling cluster changed is moved, and if the trees
+                        hold the same organisms but group them differently,
+                        some organism is moved
+
+ Usage          : ./verify_diff [<pairs>] [--seed <s>]
+ (pairs is the number of random pairs of trees checked, 3000 by default, made
+ from seed s, 1 by default. The first difference found is printed and the
+ program exits with an error.)
+
+ Build with     : g++ -std=c++11 -pthread -O2 -o verify_diff verify_diff.cpp tree_diff.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp
+
+ Last modified  : October 18, 2026
+
+ *******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "binary_tree.h"
+#include "tree_diff.h"
+
+using namespace std;
+
+/* Builds trees of any shape by joining two trees directly */
+class test_tree : public binary_tree {
+
+public:
+    test_tree() {}
+    test_tree(const string &organism) : binary_tree(organism) {}
+    test_tree(test_tree &tree1, test_tree &tree2) : binary_tree(tree1, tree2) {}
+};
+
+/* Shape of a tree to build: an organism, or two groups joined */
+struct plan {
+    string organism;        // "name score", empty for a join
+    vector<plan> parts;     // the two groups joined, left first
+};
+
+/* Builds the tree a plan describes */
+static test_tree build(const plan &p) {
+    if (p.parts.empty()) {
+        return test_tree(p.organism);
+    }
+    test_tree left = build(p.parts[0]);
+    test_tree right = build(p.parts[1]);
+    return test_tree(left, right);
+}
+
+/* Joins two random groups until one is left */
+static plan join_randomly(vector<plan> groups, mt19937 &random) {
+    while (groups.size() > 1) {
+        size_t a = random() % groups.size();
+        size_t b = random() % (groups.size() - 1);
+        if (b >= a) {
+            b++;
+        }
+        plan joined;
+        joined.parts.push_back(groups[a]);
+        joined.parts.push_back(groups[b]);
+        groups[min(a, b)] = joined;
+        groups.erase(groups.begin() + max(a, b));
+    }
+    return groups[0];
+}
+
+/* Returns the line for organism number id with the given score */
+static string organism(int id, int score) {
+    ostringstream text;
+    text << "org" << id << " " << score;
+    return text.str();
+}
+
+/* Cuts p into whole groups: each join is kept whole with probability keep,
+else cut into its two parts. Organisms are always kept. */
+static void cut(const plan &p, double keep, mt19937 &random, vector<plan> &pieces) {
+    if (p.parts.empty() || uniform_real_distribution<double>(0, 1)(random) < keep) {
+        pieces.push_back(p);
+        return;
+    }
+    cut(p.parts[0], keep, random, pieces);
+    cut(p.parts[1], keep, random, pieces);
+}
+
+/* Makes the plan for a second tree from the first: mostly cuts it into whole
+groups and joins them again in a new order, sometimes also replacing, dropping
+or adding single organisms, and sometimes keeping it unchanged. */
+static plan change(const plan &before, int &next_id, mt19937 &random) {
+
+    int kind = random() % 6;
+    if (kind == 0) {
+        return before;
+    }
+
+    vector<plan> pieces;
+    cut(before, 0.4, random, pieces);
+    if (kind >= 4) {
+        for (size_t i = 0; i < pieces.size(); i++) {
+            if (pieces[i].parts.empty() && random() % 4 == 0) {
+                // Same name, new score
+                string name = pieces[i].organism.substr(0, pieces[i].organism.find(' '));
+                ostringstream rescored;
+                rescored << name << " " << 1000 + random() % 1000;
+                pieces[i].organism = rescored.str();
+            }
+        }
+        if (pieces.size() > 1 && random() % 2 == 0) {
+            pieces.erase(pieces.begin() + random() % pieces.size());
+        }
+        if (random() % 2 == 0) {
+            plan added;
+            added.organism = organism(next_id++, random() % 1000);
+            pieces.push_back(added);
+        }
+    }
+    shuffle(pieces.begin(), pieces.end(), random);
+    return join_randomly(pieces, random);
+}
+
+/******************************************************************************
+                                BRUTE FORCE
+ ******************************************************************************/
+
+/* Every node in pre-order with its name, score and whether it is a leaf */
+static string describe(const binary_tree &tree) {
+    ostringstream text;
+    tree_range nodes = tree.pre_order();
+    for (tree_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        text << (it->is_leaf() ? "leaf " : "node ") << it->get_name() << " " << it->get_score() << "\n";
+    }
+    return text.str();
+}
+
+/* Returns the organisms below tn_ptr, sorted by name */
+static vector<string> organisms_below(const tree_node *tn_ptr) {
+    vector<string> below;
+    tree_range nodes(tn_ptr, LEAF_ORDER);
+    for (tree_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        below.push_back(it->get_name());
+    }
+    sort(below.begin(), below.end());
+    return below;
+}
+
+/* Records, below tn_ptr, each organism's score and the organisms beside it,
+and the set of organisms under every node. beside holds the organisms beside
+tn_ptr itself. */
+static void clusters(const tree_node *tn_ptr, const vector<string> &beside,
+                     map<string, vector<string> > &siblings, map<string, float> &scores,
+                     set<vector<string> > &all_clusters) {
+
+    all_clusters.insert(organisms_below(tn_ptr));
+    if (tn_ptr->is_leaf()) {
+        siblings[tn_ptr->get_name()] = beside;
+        scores[tn_ptr->get_name()] = tn_ptr->get_score();
+        return;
+    }
+    clusters(tn_ptr->get_left(), organisms_below(tn_ptr->get_right()), siblings, scores, all_clusters);
+    clusters(tn_ptr->get_right(), organisms_below(tn_ptr->get_left()), siblings, scores, all_clusters);
+}
+
+/* Checks diff against a brute force comparison of before and after */
+static bool check_pair(const binary_tree &before, const binary_tree &after, string &difference) {
+
+    tree_diff diff(before, after);
+
+    map<string, vector<string> > siblings[2];
+    map<string, float> scores[2];
+    set<vector<string> > all_clusters[2];
+    const binary_tree *trees[2] = { &before, &after };
+    for (int side = 0; side < 2; side++) {
+        tree_range nodes = trees[side]->pre_order();
+        if (nodes.begin() != nodes.end()) {
+            clusters(&*nodes.begin(), vector<string>(), siblings[side], scores[side], all_clusters[side]);
+        }
+    }
+
+    if (diff.identical() != (describe(before) == describe(after))) {
+        difference = diff.identical() ? "identical() for trees that differ" : "not identical() for equal trees";
+        return false;
+    }
+
+    vector<string> added, removed, rescored;
+    for (map<string, float>::iterator it = scores[1].begin(); it != scores[1].end(); it++) {
+        if (scores[0].count(it->first) == 0) {
+            added.push_back(it->first);
+        }
+    }
+    for (map<string, float>::iterator it = scores[0].begin(); it != scores[0].end(); it++) {
+        map<string, float>::iterator found = scores[1].find(it->first);
+        if (found == scores[1].end()) {
+            removed.push_back(it->first);
+        }
+        else if (found->second != it->second) {
+            rescored.push_back(it->first);
+        }
+    }
+    if (diff.added() != added || diff.removed() != removed || diff.rescored() != rescored) {
+        difference = "added, removed or rescored organisms differ";
+        return false;
+    }
+
+    set<string> moved(diff.moved().begin(), diff.moved().end());
+    for (set<string>::iterator it = moved.begin(); it != moved.end(); it++) {
+        if (scores[0].count(*it) == 0 || scores[1].count(*it) == 0) {
+            difference = *it + " is moved but not in both trees";
+            return false;
+        }
+    }
+    for (map<string, vector<string> >::iterator it = siblings[0].begin(); it != siblings[0].end(); it++) {
+        map<string, vector<string> >::iterator found = siblings[1].find(it->first);
+        if (found != siblings[1].end() && !found->second.empty() && !it->second.empty()
+            && found->second != it->second && moved.count(it->first) == 0) {
+            difference = it->first + " has new siblings but is not moved";
+            return false;
+        }
+    }
+    if (added.empty() && removed.empty() && rescored.empty() && all_clusters[0] != all_clusters[1]
+        && moved.empty()) {
+        difference = "organisms were regrouped but none is moved";
+        return false;
+    }
+    return true;
+}
+
+/* The trees from organisms a 0, b 1, c 10, d 11, e 20 and f 21 given in two
+orders print as ((e,f),((a,b),(c,d))) and ((a,b),((e,f),(c,d))): every pair
+is the same, only the pairs are grouped differently. */
+static bool check_regrouped_pairs(string &difference) {
+
+    const char *first_order[] = { "a 0", "b 1", "c 10", "d 11", "e 20", "f 21" };
+    const char *second_order[] = { "e 20", "f 21", "c 10", "d 11", "a 0", "b 1" };
+    list<binary_tree> first, second;
+    for (int i = 0; i < 6; i++) {
+        first.push_back(binary_tree(first_order[i]));
+        second.push_back(binary_tree(second_order[i]));
+    }
+    binary_tree before(first), after(second);
+
+    ostringstream printed;
+    printed << before << after;
+    if (printed.str() != "((e,f),((a,b),(c,d)))\n((a,b),((e,f),(c,d)))\n") {
+        difference = "built\n" + printed.str() + "instead of the regrouped pairs";
+        return false;
+    }
+
+    tree_diff diff(before, after);
+    if (diff.identical() || diff.moved().empty()) {
+        difference = "reported as identical";
+        return false;
+    }
+    return check_pair(before, after, difference);
+}
+
+/******************************************************************************
+                                MAIN PROGRAM
+ ******************************************************************************/
+
+int main(int argc, const char * argv[]) {
+
+    long pairs = 3000;
+    unsigned long seed = 1;
+    bool valid_args = true;
+
+    for (int i = 1; i < argc && valid_args; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else if (i == 1) {
+            pairs = atol(argv[i]);
+            valid_args = (pairs > 0);
+        }
+        else {
+            valid_args = false;
+        }
+    }
+
+    if (!valid_args) {
+        cerr << "ERROR: Invalid arguments" << endl;
+        cerr << "Usage: ./verify_diff [<pairs>] [--seed <s>]" << endl;
+        exit(-1);
+    }
+
+    string difference;
+    if (!check_regrouped_pairs(difference)) {
+        cout << "MISMATCH on regrouped pairs: " << difference << endl;
+        exit(-1);
+    }
+
+    mt19937 random(seed);
+    for (long t = 0; t < pairs; t++) {
+        int n = 1 + random() % 30;
+        vector<plan> organisms(n);
+        for (int i = 0; i < n; i++) {
+            organisms[i].organism = organism(i, random() % 1000);
+        }
+        plan before_plan = join_randomly(organisms, random);
+        int next_id = n;
+        plan after_plan = change(before_plan, next_id, random);
+
+        test_tree before = build(before_plan);
+        test_tree after = build(after_plan);
+        if (!check_pair(before, after, difference)) {
+            cout << "MISMATCH on pair " << t + 1 << " of " << pairs << ": " << difference << endl;
+            cout << "    " << before << "    " << after;
+            exit(-1);
+        }
+    }
+
+    cout << "Verified tree_diff on the regrouped pairs and " << pairs << " random pairs of trees" << endl;
+    return 0;
+}
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ Title          : verify_mutators.cpp
+ Author         : Anna Cristina Karingal
+ Created on     : October 18, 2026
+
+ Description    : Checks add_organism() and remove_organism() on random trees
+                    against a set of the organisms that should be in the tree:
+                    - each change succeeds or throws as the set says it should,
+                        and a change that throws leaves the tree as it was
+                    - a copy of the tree taken before a change still holds
+                        exactly what it held, node for node, afterwards
+                    - adding an organism and removing it again gives the
+                        tree before, node for node
+
+ Usage          : ./verify_mutators [<trees>] [--seed <s>]
+ (trees is the number of random trees checked, 500 by default, made from seed
+ s, 1 by default. The first difference found is printed and the program exits
+ with an error.)
+
+ Build with     : g++ -std=c++11 -pthread -O2 -o verify_mutators verify_mutators.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp
+
+ Last modified  : October 18, 2026
+
+ *******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <random>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+
+#include "binary_tree.h"
+
+using namespace std;
+
+/* Names of seven random letters. Combined trees are named with six, so no
+organism can clash with one. */
+static string random_name(mt19937 &random) {
+    string name;
+    for (int i = 0; i < 7; i++) {
+        name += (char) ('a' + random() % 26);
+    }
+    return name;
+}
+
+/* A score not yet used by any organism in scores. Whole numbers below 10^6
+are printed in full, so they read back as the same score. */
+static float unused_score(mt19937 &random, const set<float> &scores) {
+    float score;
+    do {
+        score = random() % 1000000;
+    } while (scores.count(score) > 0);
+    return score;
+}
+
+/* Every node in pre-order with its name, score, height and whether it is a
+leaf, which fixes the tree's shape as well as its data. */
+static string describe(const binary_tree &tree) {
+    ostringstream text;
+    tree_range nodes = tree.pre_order();
+    for (tree_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        text << (it->is_leaf() ? "leaf " : "node ") << it->get_name() << " "
+             << it->get_score() << " " << it->get_height() << "\n";
+    }
+    return text.str();
+}
+
+/* Organisms at the leaves of tree, by name */
+static map<string, float> organisms_in(const binary_tree &tree) {
+    map<string, float> organisms;
+    tree_range all_leaves = tree.leaves();
+    for (tree_iterator it = all_leaves.begin(); it != all_leaves.end(); ++it) {
+        organisms[it->get_name()] = it->get_score();
+    }
+    return organisms;
+}
+
+/* Builds a random tree from a list, then makes random changes to it, checking
+each one. Writes the first difference found to difference. */
+static bool check_tree(mt19937 &random, string &difference) {
+
+    map<string, float> expected;
+    set<float> scores;
+    list<binary_tree> trees;
+    size_t n = 1 + random() % 60;
+    while (expected.size() < n) {
+        string name = random_name(random);
+        if (expected.count(name) > 0) {
+            continue;
+        }
+        float score = unused_score(random, scores);
+        ostringstream organism;
+        organism << name << " " << score;
+        trees.push_back(binary_tree(organism.str()));
+        expected[name] = score;
+        scores.insert(score);
+    }
+
+    binary_tree tree(trees, SORTED_ENGINE);
+    if (random() % 2 == 0) {
+        tree.compact(random() % 2 == 0 ? DFS_LAYOUT : VEB_LAYOUT);
+    }
+
+    for (int change = 0; change < 40; change++) {
+        binary_tree snapshot = tree;
+        string before = describe(tree);
+        map<string, float> before_organisms = expected;
+
+        // Pick an organism in the tree, if there are any, and a new one
+        string present;
+        if (!expected.empty()) {
+            map<string, float>::iterator it = expected.begin();
+            advance(it, random() % expected.size());
+            present = it->first;
+        }
+        string fresh;
+        do {
+            fresh = random_name(random);
+        } while (expected.count(fresh) > 0);
+
+        int kind = random() % 5;
+        if (expected.empty()) {
+            kind = 0;
+        }
+
+        ostringstream what;
+        bool should_throw = false;
+        string added;
+        try {
+            if (kind == 0 || kind == 1) {
+                // New organism
+                float score = unused_score(random, scores);
+                ostringstream organism;
+                organism << fresh << " " << score;
+                what << "add " << organism.str();
+                tree.add_organism(organism.str());
+                expected[fresh] = score;
+                scores.insert(score);
+                added = fresh;
+            }
+            else if (kind == 2) {
+                // Existing name, or an existing score under a new name
+                bool same_name = (random() % 2 == 0);
+                ostringstream organism;
+                organism << (same_name ? present : fresh) << " "
+                         << (same_name ? unused_score(random, scores) : expected[present]);
+                what << "add " << organism.str();
+                should_throw = true;
+                tree.add_organism(organism.str());
+            }
+            else if (kind == 3) {
+                what << "remove " << present;
+                tree.remove_organism(present);
+                expected.erase(present);
+                scores.erase(before_organisms[present]);
+            }
+            else {
+                what << "remove " << fresh;
+                should_throw = true;
+                tree.remove_organism(fresh);
+            }
+            if (should_throw) {
+                difference = what.str() + ": did not throw";
+                return false;
+            }
+        }
+        catch (invalid_argument &ia) {
+            if (!should_throw) {
+                difference = what.str() + ": threw '" + ia.what() + "'";
+                return false;
+            }
+            if (describe(tree) != before) {
+                difference = what.str() + ": threw but changed the tree";
+                return false;
+            }
+        }
+
+        if (organisms_in(tree) != expected) {
+            difference = what.str() + ": tree does not hold the expected organisms";
+            return false;
+        }
+        if (describe(snapshot) != before || organisms_in(snapshot) != before_organisms) {
+            difference = what.str() + ": changed a copy taken before it";
+            return false;
+        }
+
+        if (!added.empty()) {
+            binary_tree undone = tree;
+            undone.remove_organism(added);
+            if (describe(undone) != before) {
+                difference = what.str() + ": removing it again did not give the tree before";
+                return false;
+            }
+            if (organisms_in(tree) != expected) {
+                difference = what.str() + ": removing it from a copy changed the tree";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+                                MAIN PROGRAM
+ ******************************************************************************/
+
+int main(int argc, const char * argv[]) {
+
+    long trees = 500;
+    unsigned long seed = 1;
+    bool valid_args = true;
+
+    for (int i = 1; i < argc && valid_args; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else if (i == 1) {
+            trees = atol(argv[i]);
+            valid_args = (trees > 0);
+        }
+        else {
+            valid_args = false;
+        }
+    }
+
+    if (!valid_args) {
+        cerr << "ERROR: Invalid arguments" << endl;
+        cerr << "Usage: ./verify_mutators [<trees>] [--seed <s>]" << endl;
+        exit(-1);
+    }
+
+    mt19937 random(seed);
+    for (long t = 0; t < trees; t++) {
+        string difference;
+        if (!check_tree(random, difference)) {
+            cout << "MISMATCH on tree " << t + 1 << " of " << trees << ": " << difference << endl;
+            exit(-1);
+        }
+    }
+
+    cout << "Verified adds, removes and snapshots on " << trees << " random trees" << endl;
+    return 0;
+}
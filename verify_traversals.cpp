@@ -0,0 +1,305 @@
+/*******************************************************************************
+ Title          : verify_traversals.cpp
+ Author         : Anna Cristina Karingal
+ Created on     : October 18, 2026
+
+ Description    : Checks the non-recursive traversals and the leaf index
+                    against recursive walks of random trees:
+                    - pre-order, in-order, post-order and leaf iteration visit
+                        the same nodes in the same order as a recursive walk,
+                        on trees of random shape and on long chains, before
+                        and after compacting
+                    - leaves_under(n) holds exactly the leaves reached by
+                        descending from n, in increasing order of score, for
+                        every node n of trees built from a list and then
+                        changed by adding and removing organisms
+
+ Usage          : ./verify_traversals [<trees>] [--seed <s>]
+ (trees is the number of random trees of each kind checked, 500 by default,
+ made from seed s, 1 by default. The first difference found is printed and
+ the program exits with an error.)
+
+ Build with     : g++ -std=c++11 -pthread -O2 -o verify_traversals verify_traversals.cpp leaf_index.cpp binary_tree.cpp tree_node.cpp tree_iterator.cpp
+
+ Last modified  : October 18, 2026
+
+ *******************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+
+#include "binary_tree.h"
+#include "leaf_index.h"
+
+using namespace std;
+
+/* Builds trees of any shape by joining two trees directly */
+class test_tree : public binary_tree {
+
+public:
+    test_tree() {}
+    test_tree(const string &organism) : binary_tree(organism) {}
+    test_tree(test_tree &tree1, test_tree &tree2) : binary_tree(tree1, tree2) {}
+};
+
+/* Names of seven random letters. Combined trees are named with six, so no
+organism can clash with one. */
+static string random_name(mt19937 &random) {
+    string name;
+    for (int i = 0; i < 7; i++) {
+        name += (char) ('a' + random() % 26);
+    }
+    return name;
+}
+
+/* Joins n organisms into one tree. If chain is set, each organism is joined to
+the tree built so far, on a random side, which gives a tree n levels deep;
+otherwise two random trees are joined until one is left. */
+static test_tree random_shape(size_t n, bool chain, mt19937 &random) {
+
+    vector<test_tree> trees;
+    for (size_t i = 0; i < n; i++) {
+        ostringstream organism;
+        organism << "org" << i << " " << random() % 1000;
+        trees.push_back(test_tree(organism.str()));
+    }
+
+    if (chain) {
+        test_tree tree = trees[0];
+        for (size_t i = 1; i < n; i++) {
+            tree = (random() % 2 == 0) ? test_tree(tree, trees[i]) : test_tree(trees[i], tree);
+        }
+        return tree;
+    }
+
+    while (trees.size() > 1) {
+        size_t a = random() % trees.size();
+        size_t b = random() % (trees.size() - 1);
+        if (b >= a) {
+            b++;
+        }
+        test_tree joined(trees[a], trees[b]);
+        trees[min(a, b)] = joined;
+        trees.erase(trees.begin() + max(a, b));
+    }
+    return trees[0];
+}
+
+/* Builds a tree of n organisms from a list, as the program does, then adds and
+removes organisms at random so that it is no longer a tree the list could
+have built. */
+static binary_tree random_built(size_t n, mt19937 &random) {
+
+    list<binary_tree> trees;
+    vector<string> names;
+    set<string> used_names;
+    set<int> used_scores;
+    while (names.size() < n) {
+        string name = random_name(random);
+        int score = random() % 1000000;
+        if (used_names.count(name) > 0 || used_scores.count(score) > 0) {
+            continue;
+        }
+        used_names.insert(name);
+        used_scores.insert(score);
+        names.push_back(name);
+        ostringstream organism;
+        organism << name << " " << score;
+        trees.push_back(binary_tree(organism.str()));
+    }
+
+    binary_tree tree(trees, SORTED_ENGINE);
+    for (size_t change = 0; change < n / 2; change++) {
+        if (random() % 2 == 0 && names.size() > 1) {
+            size_t victim = random() % names.size();
+            tree.remove_organism(names[victim]);
+            names[victim] = names.back();
+            names.pop_back();
+        }
+        else {
+            string name = random_name(random);
+            int score = random() % 1000000;
+            if (used_names.count(name) > 0 || used_scores.count(score) > 0) {
+                continue;
+            }
+            used_names.insert(name);
+            used_scores.insert(score);
+            names.push_back(name);
+            ostringstream organism;
+            organism << name << " " << score;
+            tree.add_organism(organism.str());
+        }
+    }
+    return tree;
+}
+
+/******************************************************************************
+                                RECURSIVE WALKS
+ ******************************************************************************/
+
+/* Appends the nodes of the subtree rooted at tn_ptr to visited in the given
+order, or only its leaves for LEAF_ORDER. */
+static void walk(const tree_node *tn_ptr, traversal_order order, vector<const tree_node *> &visited) {
+
+    if (tn_ptr == NULL) {
+        return;
+    }
+    bool leaf = tn_ptr->is_leaf();
+    if (order == PRE_ORDER || (order == LEAF_ORDER && leaf)) {
+        visited.push_back(tn_ptr);
+    }
+    walk(tn_ptr->get_left(), order, visited);
+    if (order == IN_ORDER) {
+        visited.push_back(tn_ptr);
+    }
+    walk(tn_ptr->get_right(), order, visited);
+    if (order == POST_ORDER) {
+        visited.push_back(tn_ptr);
+    }
+}
+
+/* Orders leaves by score */
+static bool lower_score(const tree_node *a, const tree_node *b) {
+    return a->get_score() < b->get_score();
+}
+
+/******************************************************************************
+                                    CHECKS
+ ******************************************************************************/
+
+/* Checks that every traversal of tree matches the recursive walk. Writes the
+first difference found to difference. */
+static bool check_traversals(const binary_tree &tree, string &difference) {
+
+    const traversal_order orders[] = { PRE_ORDER, IN_ORDER, POST_ORDER, LEAF_ORDER };
+    const char *order_names[] = { "pre-order", "in-order", "post-order", "leaf order" };
+    const tree_range named[] = { tree.pre_order(), tree.in_order(), tree.post_order(), tree.leaves() };
+
+    // Pre-order starts at the root
+    tree_range all_nodes = tree.pre_order();
+    const tree_node *root = (all_nodes.begin() == all_nodes.end()) ? NULL : &*all_nodes.begin();
+
+    for (int o = 0; o < 4; o++) {
+        vector<const tree_node *> expected;
+        walk(root, orders[o], expected);
+
+        vector<const tree_node *> visited;
+        for (tree_iterator it = named[o].begin(); it != named[o].end(); ++it) {
+            visited.push_back(&*it);
+        }
+        if (visited != expected) {
+            difference = string(order_names[o]) + " differs from a recursive walk";
+            return false;
+        }
+
+        // The same traversal through traverse() and range-for
+        vector<const tree_node *> ranged;
+        for (const tree_node &node : tree.traverse(orders[o])) {
+            ranged.push_back(&node);
+        }
+        if (ranged != expected) {
+            difference = string(order_names[o]) + " through traverse() differs from a recursive walk";
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Checks that leaves_under() gives, for every node, the leaves below it in
+increasing order of score. */
+static bool check_leaves_under(const binary_tree &tree, string &difference) {
+
+    leaf_index index(tree);
+    tree_range nodes = tree.pre_order();
+    for (tree_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        vector<const tree_node *> expected;
+        walk(&*it, LEAF_ORDER, expected);
+        sort(expected.begin(), expected.end(), lower_score);
+
+        leaf_range range = index.leaves_under(*it);
+        vector<const tree_node *> found(range.begin(), range.end());
+        if (found != expected || range.size() != expected.size()) {
+            difference = "leaves_under(" + it->get_name() + ") differs from the leaves below it";
+            return false;
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+                                MAIN PROGRAM
+ ******************************************************************************/
+
+int main(int argc, const char * argv[]) {
+
+    long trees = 500;
+    unsigned long seed = 1;
+    bool valid_args = true;
+
+    for (int i = 1; i < argc && valid_args; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 10);
+        }
+        else if (i == 1) {
+            trees = atol(argv[i]);
+            valid_args = (trees > 0);
+        }
+        else {
+            valid_args = false;
+        }
+    }
+
+    if (!valid_args) {
+        cerr << "ERROR: Invalid arguments" << endl;
+        cerr << "Usage: ./verify_traversals [<trees>] [--seed <s>]" << endl;
+        exit(-1);
+    }
+
+    mt19937 random(seed);
+    const char *layouts[] = { "as built", "after dfs compaction", "after veb compaction" };
+
+    // The empty tree has nothing to visit
+    string difference;
+    if (!check_traversals(binary_tree(), difference)) {
+        cout << "MISMATCH on the empty tree: " << difference << endl;
+        exit(-1);
+    }
+
+    for (long t = 0; t < trees; t++) {
+        bool chain = (t % 10 == 0);
+        size_t n = chain ? 1 + random() % 3000 : 1 + random() % 80;
+        binary_tree shaped = random_shape(n, chain, random);
+        binary_tree built = random_built(1 + random() % 80, random);
+
+        for (int layout = 0; layout < 3; layout++) {
+            if (layout > 0) {
+                shaped.compact(layout == 1 ? DFS_LAYOUT : VEB_LAYOUT);
+                built.compact(layout == 1 ? DFS_LAYOUT : VEB_LAYOUT);
+            }
+
+            if (!check_traversals(shaped, difference)) {
+                cout << "MISMATCH on " << (chain ? "chain" : "random shape") << " " << t + 1 << " of "
+                     << trees << " (" << n << " organisms), " << layouts[layout] << ": " << difference << endl;
+                exit(-1);
+            }
+            if (!check_traversals(built, difference) || !check_leaves_under(built, difference)) {
+                cout << "MISMATCH on built tree " << t + 1 << " of " << trees << ", "
+                     << layouts[layout] << ": " << difference << endl;
+                exit(-1);
+            }
+        }
+    }
+
+    cout << "Verified traversals on " << trees << " random trees of each shape, and leaves_under on "
+         << trees << " built and changed trees" << endl;
+    return 0;
+}